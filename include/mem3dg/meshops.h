@@ -15,6 +15,8 @@
 #pragma once
 
 #include <array>
+#include <csignal>
+#include <cstdlib>
 #include <vector>
 
 #include "geometrycentral/surface/halfedge_element_types.h"
@@ -189,6 +191,45 @@ DLL_PUBLIC inline void signalHandler(int signum) {
   exit(signum);
 }
 
+/**
+ * @brief Interrupt signal recorded by interruptHandler, 0 if none
+ */
+DLL_PUBLIC inline volatile std::sig_atomic_t &interruptSignal() {
+  static volatile std::sig_atomic_t signum = 0;
+  return signum;
+}
+
+/**
+ * @brief Signal handler that records the interrupt, so that the integrator
+ * saves and syncs the trajectory before exiting. A second interrupt exits
+ * immediately
+ */
+DLL_PUBLIC inline void interruptHandler(int signum) {
+  if (interruptSignal() != 0)
+    std::_Exit(signum);
+  interruptSignal() = signum;
+}
+
+/**
+ * @brief Install a signal handler for the lifetime of the object and restore
+ * the previous handler on destruction, e.g. the one of the Python interpreter
+ */
+class DLL_PUBLIC ScopedSignalHandler {
+public:
+  ScopedSignalHandler(int signum_, void (*handler)(int))
+      : signum(signum_), previousHandler(std::signal(signum_, handler)) {}
+  ScopedSignalHandler(const ScopedSignalHandler &) = delete;
+  ScopedSignalHandler &operator=(const ScopedSignalHandler &) = delete;
+  ~ScopedSignalHandler() {
+    if (previousHandler != SIG_ERR)
+      std::signal(signum, previousHandler);
+  }
+
+private:
+  int signum;
+  void (*previousHandler)(int);
+};
+
 // /**
 //  * @brief close a open mesh
 //  *
@@ -259,6 +300,28 @@ inline double signedVolumeFromFace(gcs::Face &f,
   return signedVolumeFromFace(p[0], p[1], p[2]);
 }
 
+/**
+ * @brief Get signed volume of the fans filling the holes of an open mesh
+ *
+ * @param mesh
+ * @param vpg
+ * @return double
+ */
+DLL_PUBLIC inline double getHoleVolume(gcs::ManifoldSurfaceMesh &mesh,
+                                       gcs::VertexPositionGeometry &vpg) {
+  double volume = 0;
+  for (gcs::BoundaryLoop bl : mesh.boundaryLoops()) {
+    gcs::Vertex theVertex = bl.halfedge().tailVertex();
+    for (gcs::Halfedge e : bl.adjacentHalfedges()) {
+      if (e.tailVertex() != theVertex && e.tipVertex() != theVertex) {
+        volume +=
+            signedVolumeFromFace(e.tailVertex(), e.tipVertex(), theVertex, vpg);
+      }
+    }
+  }
+  return volume;
+}
+
 /**
  * @brief Get mesh volume
  *
@@ -274,15 +337,7 @@ DLL_PUBLIC inline double getMeshVolume(gcs::ManifoldSurfaceMesh &mesh,
   // Throw error or fill hole for open mesh
   if (mesh.hasBoundary()) {
     if (isFillHole) {
-      for (gcs::BoundaryLoop bl : mesh.boundaryLoops()) {
-        gcs::Vertex theVertex = bl.halfedge().tailVertex();
-        for (gcs::Halfedge e : bl.adjacentHalfedges()) {
-          if (e.tailVertex() != theVertex && e.tipVertex() != theVertex) {
-            volume += signedVolumeFromFace(e.tailVertex(), e.tipVertex(),
-                                           theVertex, vpg);
-          }
-        }
-      }
+      volume += getHoleVolume(mesh, vpg);
     } else {
       mem3dg_runtime_error("Mesh is opened, not able to ",
                            "compute enclosed volume unless filled holes!");
@@ -0,0 +1,103 @@
+// Membrane Dynamics in 3D using Discrete Differential Geometry (Mem3DG)
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Copyright (c) 2020:
+//     Laboratory for Computational Cellular Mechanobiology
+//     Cuncheng Zhu (cuzhu@eng.ucsd.edu)
+//     Christopher T. Lee (ctlee@ucsd.edu)
+//     Ravi Ramamoorthi (ravir@cs.ucsd.edu)
+//     Padmini Rangamani (prangamani@eng.ucsd.edu)
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "mem3dg/macros.h"
+#include "mem3dg/type_utilities.h"
+
+namespace mem3dg {
+namespace solver {
+
+/**
+ * @brief Octree over weighted points ("charges") that approximates the
+ * self-avoidance potential sum_j q_j / (|x_j - x_i| - d0) and its gradient in
+ * O(N log N) using the Barnes-Hut monopole approximation. Excluded pairs never
+ * enter the sums, neither directly nor through a monopole
+ */
+class DLL_PUBLIC BarnesHutTree {
+public:
+  /**
+   * @brief Build the octree
+   *
+   * @param positions   point coordinates, N x 3
+   * @param charges     point weights, N x 1
+   * @param exclusionStart  row offsets of the excluded pairs, (N + 1) x 1
+   * @param exclusions  excluded neighbors j > i of each point i in compressed
+   * rows
+   * @param leafSize    maximum number of points in a leaf
+   */
+  void build(const Eigen::Ref<const EigenVectorX3dr> &positions,
+             const Eigen::Ref<const EigenVectorX1d> &charges,
+             const std::vector<std::size_t> &exclusionStart,
+             const std::vector<std::size_t> &exclusions,
+             std::size_t leafSize = 8);
+
+  /**
+   * @brief Evaluate the potential and field on all points, excluding self
+   * interaction and excluded pairs. A node is approximated by its total charge
+   * at its charge center if (node width) / (distance) < theta and it holds no
+   * excluded neighbor of the point; theta = 0 is exact
+   *
+   * @param theta       opening angle
+   * @param d0          limit distance of the penalty
+   * @param potential   sum_j q_j / (r_ij - d0), N x 1
+   * @param field       sum_j q_j / (r_ij - d0)^2 * (x_j - x_i) / r_ij, N x 3
+   */
+  void evaluate(double theta, double d0, EigenVectorX1d &potential,
+                EigenVectorX3dr &field) const;
+
+private:
+  struct Node {
+    /// geometric center of the cube
+    Eigen::Vector3d center;
+    /// half of the cube width
+    double halfWidth;
+    /// total charge
+    double charge;
+    /// charge weighted center
+    Eigen::Vector3d chargeCenter;
+    /// range of the node in sortedPoints
+    std::size_t begin, end;
+    /// index of the first of the 8 consecutive children, 0 for leaf
+    std::size_t firstChild;
+  };
+
+  /// recursively subdivide the node
+  void subdivide(std::size_t nodeIndex, std::size_t depth);
+
+  /// cached point coordinates
+  EigenVectorX3dr points;
+  /// cached point charges
+  EigenVectorX1d charges;
+  /// point indices ordered such that every node is a contiguous range
+  std::vector<std::size_t> sortedPoints;
+  /// row offsets of excludedRanks, (N + 1) x 1
+  std::vector<std::size_t> excludedStart;
+  /// sorted positions in sortedPoints of all excluded neighbors of each point
+  std::vector<std::size_t> excludedRanks;
+  /// nodes of the octree, root first
+  std::vector<Node> nodes;
+  /// maximum number of points in a leaf
+  std::size_t leafSize = 8;
+};
+
+} // namespace solver
+} // namespace mem3dg
@@ -0,0 +1,63 @@
+// Membrane Dynamics in 3D using Discrete Differential Geometry (Mem3DG)
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Copyright (c) 2020:
+//     Laboratory for Computational Cellular Mechanobiology
+//     Cuncheng Zhu (cuzhu@eng.ucsd.edu)
+//     Christopher T. Lee (ctlee@ucsd.edu)
+//     Ravi Ramamoorthi (ravir@cs.ucsd.edu)
+//     Padmini Rangamani (prangamani@eng.ucsd.edu)
+//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include <Eigen/Core>
+
+#include "mem3dg/macros.h"
+#include "mem3dg/type_utilities.h"
+
+namespace mem3dg {
+namespace solver {
+
+/**
+ * @brief Counter-based random number generator Philox4x32-10 (Salmon et al.,
+ * SC'11). A block of random bits is a pure function of the counter and the
+ * key, so that any entry of a stream can be generated independently by any
+ * thread, in any order
+ */
+class DLL_PUBLIC Philox4x32 {
+public:
+  using Counter = std::array<std::uint32_t, 4>;
+  using Key = std::array<std::uint32_t, 2>;
+
+  /**
+   * @brief Generate a block of 128 random bits
+   *
+   * @param counter     128-bit counter
+   * @param key         64-bit key
+   * @return            128 random bits
+   */
+  static Counter generate(Counter counter, Key key);
+
+  /**
+   * @brief Fill a vector with standard normal deviates using the Box-Muller
+   * transform, two deviates per block. Entry i is a function of (seed, step, i)
+   * only, regardless of the number of threads
+   *
+   * @param seed        key of the stream
+   * @param step        index of the stream, e.g. time step
+   * @param normal      output, resized by the caller
+   */
+  static void fillNormal(std::uint64_t seed, std::uint64_t step,
+                         Eigen::Ref<EigenVectorX1d> normal);
+};
+
+} // namespace solver
+} // namespace mem3dg
@@ -141,6 +141,12 @@ struct Forces {
   /// protein mask
   gcs::VertexData<double> proteinMask;
 
+  /// whether to keep the per-component force buffers and their normal
+  /// projections during stepping. If false, only mechanicalForceVec,
+  /// mechanicalForce and chemicalPotential are maintained, and the components
+  /// are computed on demand by System::computeForceComponents
+  bool isFullDiagnostics = true;
+
   Forces(gcs::ManifoldSurfaceMesh &mesh_, gcs::VertexPositionGeometry &vpg_)
       : mesh(mesh_), vpg(vpg_), mechanicalForce(mesh, 0),
         mechanicalForceVec(mesh, {0, 0, 0}), bendingForceVec(mesh, {0, 0, 0}),
@@ -350,6 +356,56 @@ struct Forces {
   double maskProtein(double &&potential, gc::Vertex &v) {
     return potential * proteinMask[v];
   }
+
+  // ==========================================================
+  // =============      In-place helpers        ===============
+  // ==========================================================
+
+  /**
+   * @brief In-place and output-parameter variants of the helpers above. The
+   * output has to be defined on the mesh, so that no heap allocation occurs
+   */
+  void maskForceInPlace(gcs::VertexData<gc::Vector3> &vector) const {
+    gc::EigenMap<double, 3>(vector).array() *=
+        gc::EigenMap<double, 3>(forceMask).array();
+  }
+
+  void maskProteinInPlace(gcs::VertexData<double> &potential) const {
+    potential.raw().array() *= proteinMask.raw().array();
+  }
+
+  void ontoNormal(const gcs::VertexData<gc::Vector3> &vector,
+                  gcs::VertexData<double> &projection) const {
+    for (std::size_t i = 0; i < mesh.nVertices(); ++i) {
+      projection[i] = gc::dot(vector[i], vpg.vertexNormals[i]);
+    }
+  }
+
+  void addNormal(const gcs::VertexData<double> &vector,
+                 gcs::VertexData<gc::Vector3> &result) const {
+    for (std::size_t i = 0; i < mesh.nVertices(); ++i) {
+      result[i] = vector[i] * vpg.vertexNormals[i];
+    }
+  }
+
+  void toTangent(const gcs::VertexData<gc::Vector3> &vector,
+                 gcs::VertexData<gc::Vector3> &result) const {
+    for (std::size_t i = 0; i < mesh.nVertices(); ++i) {
+      result[i] = vector[i] - gc::dot(vector[i], vpg.vertexNormals[i]) *
+                                  vpg.vertexNormals[i];
+    }
+  }
+
+  /**
+   * @brief Mask the force on a vertex in place, add it to the sum and return
+   * its projection onto the angle-weighted normal
+   */
+  double maskProjectAccumulate(gc::Vector3 &vector, gc::Vector3 &sum,
+                               const std::size_t i) const {
+    vector = maskForce(vector, i);
+    sum += vector;
+    return ontoNormal(vector, i);
+  }
 };
 
 } // namespace solver
@@ -0,0 +1,131 @@
+// Membrane Dynamics in 3D using Discrete Differential Geometry (Mem3DG)
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Copyright (c) 2020:
+//     Laboratory for Computational Cellular Mechanobiology
+//     Cuncheng Zhu (cuzhu@eng.ucsd.edu)
+//     Christopher T. Lee (ctlee@ucsd.edu)
+//     Ravi Ramamoorthi (ravir@cs.ucsd.edu)
+//     Padmini Rangamani (prangamani@eng.ucsd.edu)
+//
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <geometrycentral/surface/manifold_surface_mesh.h>
+#include <geometrycentral/surface/vertex_position_geometry.h>
+
+#include <Eigen/Core>
+#include <Eigen/SparseCore>
+
+#include "mem3dg/macros.h"
+#include "mem3dg/type_utilities.h"
+
+namespace gcs = ::geometrycentral::surface;
+
+namespace mem3dg {
+namespace solver {
+
+/**
+ * @brief Bitmask of the optional geometric quantities kept up to date on
+ * refresh. Face normals and areas, edge lengths and dihedral angles, corner
+ * angles, halfedge cotan weights, vertex normals, dual areas and mean
+ * curvatures are read by every force evaluation and always required
+ */
+namespace GeometricQuantity {
+enum : unsigned {
+  GaussianCurvatures = 1 << 0,
+  CotanLaplacian = 1 << 1,
+  LumpedMassMatrix = 1 << 2,
+  DECOperators = 1 << 3,
+  All = (1 << 4) - 1
+};
+} // namespace GeometricQuantity
+
+/**
+ * @brief Fused computation of the geometric quantities read by the force
+ * kernel. Face normals and areas, corner angles, halfedge cotan weights, edge
+ * lengths and dihedral angles, vertex dual areas, normals, mean and Gaussian
+ * curvatures are computed in a face, an edge and a vertex sweep over flat index
+ * arrays, and written to the buffers of the geometry-central geometry so that
+ * downstream code is unchanged. The sparse operators only have their values
+ * overwritten, reusing the sparsity pattern of the current topology
+ */
+class DLL_PUBLIC GeometryKernel {
+public:
+  /**
+   * @brief Build the flat connectivity arrays
+   *
+   * @param mesh        compressed mesh
+   */
+  void build(gcs::ManifoldSurfaceMesh &mesh);
+
+  /**
+   * @brief Whether the connectivity arrays have been built for a mesh of the
+   * same size
+   */
+  bool isBuiltFor(gcs::ManifoldSurfaceMesh &mesh) const;
+
+  /**
+   * @brief Recompute the quantities from vpg.inputVertexPositions. The
+   * quantities have to be allocated, i.e. required and computed at least once
+   * since the last change of topology
+   *
+   * @param vpg         geometry of the mesh passed to build
+   * @param quantities  bitmask of GeometricQuantity to compute in addition
+   * @return            signed volume enclosed by the faces
+   */
+  double compute(gcs::VertexPositionGeometry &vpg, unsigned quantities);
+
+private:
+  /// vertex indices of each face, starting from the tail of f.halfedge()
+  Eigen::Matrix<std::size_t, Eigen::Dynamic, 3, Eigen::RowMajor> faceVertices;
+  /// halfedge indices of each face, the k-th halfedge is outgoing from the
+  /// k-th vertex
+  Eigen::Matrix<std::size_t, Eigen::Dynamic, 3, Eigen::RowMajor> faceHalfedges;
+  /// corner indices of each face, the k-th corner is at the k-th vertex
+  Eigen::Matrix<std::size_t, Eigen::Dynamic, 3, Eigen::RowMajor> faceCorners;
+  /// tail and tip vertex indices of e.halfedge() of each edge
+  Eigen::Matrix<std::size_t, Eigen::Dynamic, 2, Eigen::RowMajor> edgeVertices;
+  /// e.halfedge() and its twin of each edge
+  Eigen::Matrix<std::size_t, Eigen::Dynamic, 2, Eigen::RowMajor> edgeHalfedges;
+  /// face indices on both sides of each edge, meaningless on boundary edges
+  Eigen::Matrix<std::size_t, Eigen::Dynamic, 2, Eigen::RowMajor> edgeFaces;
+  /// whether the edge is on the boundary
+  std::vector<char> isBoundaryEdge;
+  /// whether the vertex is on the boundary
+  std::vector<char> isBoundaryVertex;
+  /// indices of the exterior halfedges
+  std::vector<std::size_t> exteriorHalfedges;
+  /// row offsets of the vertex-corner adjacency, (N + 1) x 1
+  std::vector<std::size_t> vertexCornerStart;
+  /// corner and face indices adjacent to each vertex in compressed rows
+  std::vector<std::size_t> vertexCorners, vertexCornerFaces;
+  /// row offsets of the vertex-edge adjacency, (N + 1) x 1
+  std::vector<std::size_t> vertexEdgeStart;
+  /// edge indices adjacent to each vertex in compressed rows
+  std::vector<std::size_t> vertexEdges;
+  /// signed volume of the tetrahedron between each face and the origin
+  EigenVectorX1d faceVolumes;
+  /// cotan weight of each edge
+  EigenVectorX1d edgeCotanWeights;
+
+  /// locate the nonzeros of each edge and vertex in the cotan Laplacian
+  void buildLaplacianOffsets(const Eigen::SparseMatrix<double> &laplacian);
+  /// whether laplacianEdgeOffsets matches the current topology
+  bool isLaplacianOffsetsBuilt = false;
+  /// offsets in the value array of the (tail, tip) and (tip, tail) nonzeros of
+  /// each edge
+  Eigen::Matrix<std::ptrdiff_t, Eigen::Dynamic, 2, Eigen::RowMajor>
+      laplacianEdgeOffsets;
+  /// offsets in the value array of the diagonal nonzero of each vertex
+  std::vector<std::ptrdiff_t> laplacianDiagonalOffsets;
+};
+
+} // namespace solver
+} // namespace mem3dg
@@ -14,6 +14,8 @@
 
 #pragma once
 
+#include <deque>
+
 #include "mem3dg/solver/integrator/integrator.h"
 #include "mem3dg/solver/system.h"
 
@@ -24,60 +26,62 @@ namespace integrator {
 // =============              BFGS              =============
 // ==========================================================
 /**
- * @brief BFGS optimizer
- * @param ctol, tolerance for termination (contraints)
+ * @brief Limited-memory BFGS optimizer. The inverse Hessian is never formed;
+ * the search direction is computed by two-loop recursion over the last
+ * historyLength (s, y) pairs, separately for the shape and protein variables,
+ * which takes O(historyLength * N) memory
+ * @param historyLength, number of stored (s, y) correction pairs
  * @param isBacktrack, option to use backtracking line search algorithm
  * @param rho, backtracking coefficient
  * @param c1, Wolfe condition parameter
+ * @param constraintTolerance, tolerance for termination (contraints)
  * @param isAugmentedLagrangian, option to use Augmented Lagrangian method
  * @return Success, if simulation is sucessful
  */
 class DLL_PUBLIC BFGS : public Integrator {
 private:
-  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> hess_inv;
-  Eigen::Matrix<double, Eigen::Dynamic, 1> pastPhysicalForce;
-  Eigen::Matrix<double, Eigen::Dynamic, 1> s;
+  /// past shape and protein displacements s_k = x_{k+1} - x_k
+  std::deque<EigenVectorX1d> sHistory, sHistory_protein;
+  /// past gradient differences y_k = g_{k+1} - g_k
+  std::deque<EigenVectorX1d> yHistory, yHistory_protein;
+
+  /// forces and displacement of the last step, pending update of the history
+  EigenVectorX1d pastPhysicalForce, pastPhysicalForce_protein;
+  EigenVectorX1d s, s_protein;
+  bool isHistoryPending = false;
 
-  Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> hess_inv_protein;
-  Eigen::Matrix<double, Eigen::Dynamic, 1> pastPhysicalForce_protein;
-  Eigen::Matrix<double, Eigen::Dynamic, 1> s_protein;
+  /**
+   * @brief Append the pair (s, y) to the history if it satisfies the curvature
+   * condition s^T y > 0, dropping the oldest pair beyond historyLength
+   */
+  void updateHistory(std::deque<EigenVectorX1d> &sHistory_,
+                     std::deque<EigenVectorX1d> &yHistory_,
+                     const EigenVectorX1d &s_, EigenVectorX1d &&y_);
+
+  /**
+   * @brief Two-loop recursion, overwrite q with H * q where H is the
+   * limited-memory inverse Hessian approximation
+   */
+  void twoLoopRecursion(const std::deque<EigenVectorX1d> &sHistory_,
+                        const std::deque<EigenVectorX1d> &yHistory_,
+                        EigenVectorX1d &q) const;
 
 public:
-  const bool isBacktrack;
-  const double rho;
-  const double c1;
-  const double ctol;
-  const bool isAugmentedLagrangian;
-  bool ifRestart;
+  std::size_t historyLength = 10;
+  bool isBacktrack = true;
+  double rho = 0.99;
+  double c1 = 0.0001;
+  double constraintTolerance = 0.001;
+  bool isAugmentedLagrangian = false;
+
   BFGS(System &system_, double characteristicTimeStep_, double totalTime_,
-       double savePeriod_, double tolerance_, std::string outputDirectory_,
-       bool isAdaptiveStep_, std::string trajFileName_, std::size_t verbosity_,
-       bool isBacktrack_, double rho_, double c1_, double ctol_,
-       bool isAugmentedLagrangian_)
+       double savePeriod_, double tolerance_, std::string outputDirectory_)
       : Integrator(system_, characteristicTimeStep_, totalTime_, savePeriod_,
-                   tolerance_, outputDirectory_),
-        isBacktrack(isBacktrack_), rho(rho_), c1(c1_), ctol(ctol_),
-        isAugmentedLagrangian(isAugmentedLagrangian_), ifRestart(false) {
-
-    mem3dg_runtime_error("BFGS is currently not tested and maintained!");
+                   tolerance_, outputDirectory_) {
 
     // print to console
     std::cout << "Running BFGS propagator ..." << std::endl;
 
-    hess_inv.resize(system.mesh->nVertices() * 3, system.mesh->nVertices() * 3);
-    hess_inv.setIdentity();
-    pastPhysicalForce.resize(system.mesh->nVertices() * 3, 1);
-    pastPhysicalForce.setZero();
-    s.resize(system.mesh->nVertices() * 3, 1);
-    s.setZero();
-
-    hess_inv_protein.resize(system.mesh->nVertices(), system.mesh->nVertices());
-    hess_inv_protein.setIdentity();
-    pastPhysicalForce_protein.resize(system.mesh->nVertices(), 1);
-    pastPhysicalForce_protein.setZero();
-    s_protein.resize(system.mesh->nVertices(), 1);
-    s_protein.setZero();
-
     // check the validity of parameter
     checkParameters();
   }
@@ -102,6 +106,11 @@ public:
    */
   void checkParameters() override;
 
+  /**
+   * @brief Discard the stored (s, y) pairs and restart from steepest descent
+   */
+  void resetHistory();
+
   /**
    * @brief step for n iterations
    */
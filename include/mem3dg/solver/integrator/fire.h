@@ -0,0 +1,107 @@
+// Membrane Dynamics in 3D using Discrete Differential Geometry (Mem3DG)
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Copyright (c) 2020:
+//     Laboratory for Computational Cellular Mechanobiology
+//     Cuncheng Zhu (cuzhu@eng.ucsd.edu)
+//     Christopher T. Lee (ctlee@ucsd.edu)
+//     Ravi Ramamoorthi (ravir@cs.ucsd.edu)
+//     Padmini Rangamani (prangamani@eng.ucsd.edu)
+//
+
+#pragma once
+
+#include "mem3dg/solver/integrator/integrator.h"
+#include "mem3dg/solver/system.h"
+
+namespace mem3dg {
+namespace solver {
+namespace integrator {
+/**
+ * @brief Fast Inertial Relaxation Engine (FIRE) minimizer. Semi-implicit
+ * Euler dynamics of unit mass whose velocity is mixed toward the force and
+ * zeroed on uphill motion, with time step and mixing adapted on the power
+ * P = F . v. Only forces are evaluated while stepping; the energy is
+ * evaluated on save frames
+ * @param delayStep, number of downhill steps before accelerating
+ * @param timeStepIncrease, factor to grow the time step when accelerating
+ * @param timeStepDecrease, factor to shrink the time step on uphill motion
+ * @param initialMixing, mixing parameter at the start and after uphill motion
+ * @param mixingDecrease, factor to shrink the mixing when accelerating
+ * @param maxTimeStepFactor, maximum time step in characteristic time steps
+ * @param minTimeStepFactor, minimum time step in characteristic time steps
+ * @return Success, if simulation is sucessful
+ */
+class DLL_PUBLIC FIRE : public Integrator {
+private:
+  /// mixing parameter between the velocity and the force direction
+  double mixing = 0.1;
+  /// number of consecutive steps with positive power
+  std::size_t positivePowerCount = 0;
+
+public:
+  std::size_t delayStep = 5;
+  double timeStepIncrease = 1.1;
+  double timeStepDecrease = 0.5;
+  double initialMixing = 0.1;
+  double mixingDecrease = 0.99;
+  double maxTimeStepFactor = 10;
+  double minTimeStepFactor = 0.02;
+
+  FIRE(System &system_, double characteristicTimeStep_, double totalTime_,
+       double savePeriod_, double tolerance_, std::string outputDirectory_)
+      : Integrator(system_, characteristicTimeStep_, totalTime_, savePeriod_,
+                   tolerance_, outputDirectory_) {
+
+    // print to console
+    std::cout << "Running FIRE propagator ..." << std::endl;
+
+    // start at rest
+    resetDynamics();
+
+    // check the validity of parameter
+    checkParameters();
+  }
+
+  /**
+   * @brief FIRE driver function
+   */
+  bool integrate() override;
+
+  /**
+   * @brief FIRE stepper
+   */
+  void march() override;
+
+  /**
+   * @brief FIRE status computation and thresholding
+   */
+  void status() override;
+
+  /**
+   * @brief Check parameters for time integration
+   */
+  void checkParameters() override;
+
+  /**
+   * @brief Stop the inertial motion and restore the initial time step and
+   * mixing
+   */
+  void resetDynamics();
+
+  /**
+   * @brief step for n iterations
+   */
+  void step(std::size_t n) {
+    for (std::size_t i = 0; i < n; i++) {
+      status();
+      march();
+    }
+  }
+};
+} // namespace integrator
+} // namespace solver
+} // namespace mem3dg
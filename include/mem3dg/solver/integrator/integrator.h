@@ -15,6 +15,7 @@
 #pragma once
 
 #include <cstddef>
+#include <Eigen/SparseCholesky>
 #include <geometrycentral/surface/geometry.h>
 #include <geometrycentral/surface/halfedge_mesh.h>
 #include <geometrycentral/surface/meshio.h>
@@ -30,6 +31,7 @@
 
 #include "mem3dg/meshops.h"
 #include "mem3dg/solver/mutable_trajfile.h"
+#include "mem3dg/solver/trajectory_writer.h"
 #include "mem3dg/solver/trajfile.h"
 
 #include <csignal>
@@ -70,10 +72,64 @@ protected:
   double dt_size2_ratio;
   /// initial maximum force
   double initialMaximumForce;
+  /// accepted step and directional derivative of the last line search, used
+  /// to warm start the next one
+  struct LineSearchHistory {
+    double step = 0;
+    double projection = 0;
+  };
+  LineSearchHistory backtrackHistory;
+  LineSearchHistory mechanicalBacktrackHistory;
+  LineSearchHistory chemicalBacktrackHistory;
+  /// configuration, forces and energy at the start of a line search, kept
+  /// across steps so that its buffers are only reallocated when the number of
+  /// vertices changes
+  struct LineSearchSnapshot {
+    EigenVectorX3dr position;
+    EigenVectorX1d proteinDensity;
+    EigenVectorX3dr mechanicalForceVec;
+    EigenVectorX1d mechanicalForce;
+    EigenVectorX1d chemicalPotential;
+    double mechErrorNorm = 0;
+    double chemErrorNorm = 0;
+    double time = 0;
+    Energy energy;
+  };
+  LineSearchSnapshot lineSearchSnapshot;
+  /// number of line searches performed
+  std::size_t lineSearchCount = 0;
+  /// number of trial energy evaluations over all line searches
+  std::size_t lineSearchEvaluationCount = 0;
+  /// Sobolev metric of the last numeric factorization
+  Eigen::SparseMatrix<double> sobolevMetric;
+  /// factorization of the Sobolev metric, the symbolic analysis is reused
+  /// until the topology changes
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> sobolevSolver;
+  /// whether sobolevSolver holds a valid numeric factorization
+  bool isSobolevFactorized = false;
+  /// number of preconditioned steps since the last numeric factorization
+  std::size_t sobolevFactorizationAge = 0;
+  /// lower bound of the ratio of the stable time steps of the preconditioned
+  /// and bare gradient flows, applied to the adaptive step
+  double sobolevStepGain = 1;
+  /// cotan Laplacian of the last implicit diffusion factorization
+  Eigen::SparseMatrix<double> diffusionLaplacian;
+  /// protein mask of the last implicit diffusion factorization
+  EigenVectorX1d diffusionMask;
+  /// dt * eta * mobility of the last implicit diffusion factorization
+  double diffusionCoefficient = 0;
+  /// factorization of the backward Euler diffusion operator
+  Eigen::SimplicialLDLT<Eigen::SparseMatrix<double>> diffusionSolver;
   /// TrajFile
 #ifdef MEM3DG_WITH_NETCDF
   TrajFile trajFile;
   MutableTrajFile mutableTrajFile;
+  /// whether a topology has been written to mutableTrajFile
+  bool isTopologySaved = false;
+  /// System::topologyVersion of the topology last written to mutableTrajFile
+  std::uint64_t savedTopologyVersion = 0;
+  /// writer thread of mutableTrajFile, declared after it to be stopped first
+  TrajectoryWriter trajectoryWriter;
 #endif
 
 public:
@@ -102,6 +158,49 @@ public:
   size_t verbosity = 3;
   /// just save geometry .ply file
   bool isJustGeometryPly = false;
+  /// option to store per-vertex trajectory data in chunked, compressed
+  /// variables per topology epoch instead of vlen arrays
+  bool isChunkedTrajectory = false;
+#ifdef MEM3DG_WITH_NETCDF
+  /// storage precision of the per-vertex trajectory data, e.g. single
+  /// precision coordinates or int16 protein density
+  TrajStorage trajectoryStorage;
+#endif
+  /// option to write the trajectory in a background thread
+  bool isAsyncTrajectoryWriter = false;
+  /// maximum number of frames queued or being written by the background
+  /// thread, the simulation blocks when the queue is full
+  std::size_t trajectoryQueueCapacity = 2;
+  /// sync the trajectory file every syncPeriod frames, 0 to only sync on exit
+  std::size_t syncPeriod = 1;
+  /// option to finish the simulation on SIGINT, saving and syncing the last
+  /// frame, instead of exiting immediately
+  bool isSyncOnInterrupt = true;
+  /// option to choose trial steps by quadratic/cubic interpolation instead of
+  /// a fixed backtracking ratio
+  bool isInterpolatingLineSearch = false;
+  /// option to enforce the strong Wolfe curvature condition in the
+  /// interpolating line search
+  bool isStrongWolfe = false;
+  /// constant for the curvature condition, c1 < c2 < 1
+  double c2 = 0.9;
+  /// option to precondition the shape force with the H^2 Sobolev metric,
+  /// damping the high frequencies that limit the time step of plain gradient
+  /// flow to O(h^4). The adaptive step is enlarged by the damping of the
+  /// metric
+  bool isSobolevPreconditioned = false;
+  /// squared smoothing length of the Sobolev metric, in units of the squared
+  /// mean edge length
+  double sobolevScale = 1;
+  /// number of preconditioned steps between numeric refactorizations of the
+  /// Sobolev metric
+  std::size_t sobolevRefactorizationPeriod = 10;
+  /// option to split off the Dirichlet (line tension) term of the protein
+  /// dynamics and integrate it by backward Euler after the explicit step
+  bool isImplicitProteinDiffusion = false;
+  /// relative change of the cotan Laplacian or the diffusion coefficient that
+  /// triggers a refactorization of the implicit diffusion operator
+  double diffusionRefactorizationTolerance = 0.01;
 
   // ==========================================================
   // =============        Constructor            ==============
@@ -172,7 +271,9 @@ public:
    */
   void saveNetcdfData();
   /**
-   * @brief Save data to netcdf traj file
+   * @brief Save data to netcdf traj file, through the background writer if
+   * isAsyncTrajectoryWriter. The file is synced according to syncPeriod and
+   * on exit
    */
   void saveMutableNetcdfData();
 
@@ -233,9 +334,37 @@ public:
                                    const double dArea, const double ctol,
                                    double increment);
 
+  /**
+   * @brief Snapshot the current configuration, forces and energy as the
+   * origin of a line search
+   */
+  void captureLineSearchSnapshot();
+
+  /**
+   * @brief Return the system to the line search snapshot, the energy and
+   * forces are restored without being recomputed
+   */
+  void restoreLineSearchSnapshot();
+
+  /**
+   * @brief Restore the forces of the line search snapshot
+   */
+  void restoreLineSearchForces();
+
+  /**
+   * @brief Place the system at snapshot + alpha * direction and evaluate the
+   * potential energy there
+   */
+  void evaluateLineSearchTrial(
+      double alpha,
+      const Eigen::Matrix<double, Eigen::Dynamic, 3> &positionDirection,
+      const Eigen::Matrix<double, Eigen::Dynamic, 1> &chemicalDirection,
+      bool isShape, bool isProtein);
+
   /**
    * @brief Backtracking algorithm that dynamically adjust step size based on
-   * energy evaluation
+   * energy evaluation. The system is left at the accepted step, including the
+   * time, with its geometry and potential energy up to date
    * @param positionDirection, direction of shape, most likely some function of
    * gradient
    * @param chemicalDirection, direction of protein density, most likely some
@@ -250,7 +379,7 @@ public:
 
   /**
    * @brief Backtracking algorithm that dynamically adjust step size based on
-   * energy evaluation
+   * energy evaluation, leaving the system at the accepted step
    * @param positionDirection, direction of shape, most likely some function of
    * gradient
    * @param rho, discount factor
@@ -263,7 +392,7 @@ public:
 
   /**
    * @brief Backtracking algorithm that dynamically adjust step size based on
-   * energy evaluation
+   * energy evaluation, leaving the system at the accepted step
    * @param chemicalDirection, direction of protein density, most likely some
    * function of gradient
    * @param rho, discount factor
@@ -274,6 +403,68 @@ public:
       Eigen::Matrix<double, Eigen::Dynamic, 1> &&chemicalDirection,
       double rho = 0.7, double c1 = 0.001);
 
+  /**
+   * @brief Line search that picks trial steps by minimizing the quadratic or
+   * cubic interpolant of the energy along the direction, using the known
+   * directional derivative at the origin. The first trial is the previously
+   * accepted step scaled by the ratio of directional derivatives, capped at
+   * the characteristic time step. Optionally enforces the strong Wolfe
+   * conditions, which takes a force evaluation per trial
+   * @param positionDirection, direction of shape, ignored if not isShape
+   * @param chemicalDirection, direction of protein density, ignored if not
+   * isProtein
+   * @param isShape, whether to step the shape
+   * @param isProtein, whether to step the protein density
+   * @param projection, inner product of the force and the direction
+   * @param c1, constant for Wolfe condtion, between 0 to 1, usually ~ 1e-4
+   * @param history, warm start state of this kind of line search
+   * @return alpha, line search step size
+   */
+  double interpolatingLineSearch(
+      const Eigen::Matrix<double, Eigen::Dynamic, 3> &positionDirection,
+      const Eigen::Matrix<double, Eigen::Dynamic, 1> &chemicalDirection,
+      bool isShape, bool isProtein, double projection, double c1,
+      LineSearchHistory &history);
+
+  /**
+   * @brief Precondition the shape force with the Sobolev metric
+   * (M + tau L) M^-1 (M + tau L), where M is the lumped mass matrix, L the
+   * cotan Laplacian and tau = sobolevScale * (mean edge length)^2. The metric
+   * is symbolically analyzed once per topology and numerically refactorized
+   * every sobolevRefactorizationPeriod calls. The result is scaled by the mean
+   * vertex area, such that tau = 0 recovers the force on a uniform mesh
+   * @param force, masked shape force, N x 3
+   * @return masked preconditioned direction, N x 3
+   */
+  EigenVectorX3dr sobolevPrecondition(const EigenVectorX3dr &force);
+
+  /**
+   * @brief Backward Euler step of the Dirichlet protein diffusion,
+   * (I + dt eta mobility L) phi = phi*, with the masked vertices held fixed.
+   * The factorization is reused until the topology or the protein mask
+   * changes, or the Laplacian or the coefficient drifts beyond
+   * diffusionRefactorizationTolerance
+   * @param dt, time step
+   */
+  void implicitProteinDiffusion(double dt);
+
+  /**
+   * @brief Protein velocity of the explicit step, which excludes the
+   * diffusion potential if isImplicitProteinDiffusion
+   * @return
+   */
+  EigenVectorX1d explicitProteinVelocity();
+
+  /**
+   * @brief Average number of trial energy evaluations per line search
+   * @return
+   */
+  double getAverageLineSearchEvaluations() const {
+    return (lineSearchCount == 0)
+               ? 0.0
+               : double(lineSearchEvaluationCount) / lineSearchCount;
+  }
+
   /**
    * @brief Check finiteness of simulation states and backtrack for error in
    * specific component
@@ -287,9 +478,9 @@ public:
    * @return
    */
   void lineSearchErrorBacktrace(const double alpha,
-                                const EigenVectorX3dr initial_pos,
-                                const EigenVectorX1d init_proteinDensity,
-                                const Energy previousE, bool runAll = false);
+                                const EigenVectorX3dr &initial_pos,
+                                const EigenVectorX1d &init_proteinDensity,
+                                const Energy &previousE, bool runAll = false);
 
   /**
    * @brief get adaptive characteristic time step
@@ -22,9 +22,11 @@
 
 #ifdef MEM3DG_WITH_NETCDF
 
+#include <algorithm>
 #include <exception>
 #include <iostream>
 #include <netcdf>
+#include <string>
 #include <vector>
 
 #include <Eigen/Core>
@@ -37,6 +39,7 @@
 #include "mem3dg/macros.h"
 #include "mem3dg/meshops.h"
 #include "mem3dg/solver/trajfile_constants.h"
+#include "mem3dg/solver/trajfile_storage.h"
 #include "mem3dg/type_utilities.h"
 
 namespace mem3dg {
@@ -54,6 +57,36 @@ namespace nc = ::netCDF;
  */
 class DLL_PUBLIC MutableTrajFile {
 private:
+  /// Group and variables of a run of frames with constant topology in the
+  /// chunked layout. Per-vertex data is stored as (epochframe, nvertices[,
+  /// spatial]) variables with one compressed chunk per frame
+  struct Epoch {
+    /// first frame of the epoch
+    std::size_t start;
+    /// number of vertices
+    std::size_t nVertices;
+    nc::NcGroup group;
+    /// topology, written once
+    nc::NcVar topo_var;
+    nc::NcVar coord_var;
+    nc::NcVar phi_var;
+    nc::NcVar vel_var;
+    nc::NcVar extF_var;
+  };
+
+  /// Element read from a vlen variable. netCDF allocates its storage, which
+  /// is released on destruction
+  struct VlenBuffer {
+    nc_vlen_t data{0, nullptr};
+    VlenBuffer() = default;
+    VlenBuffer(const VlenBuffer &) = delete;
+    VlenBuffer &operator=(const VlenBuffer &) = delete;
+    ~VlenBuffer() {
+      if (data.p != nullptr)
+        nc_free_vlen(&data);
+    }
+  };
+
   /* Do not allow definition of NcFile involving copying any NcFile or
     NcGroup. Because the destructor closes the file and releases al resources
     such an action could leave NcFile objects in an invalid state from NcFile.h
@@ -71,6 +104,8 @@ public:
    *
    * @param filename  Filename to save to
    * @param replace   Whether to replace an existing file or exit
+   * @param isChunked Whether to use the chunked layout
+   * @param storage   Storage precision of the per-vertex variables
    *
    * @exception netCDF::exceptions::NcExist File already exists and
    * replace/overwrite flag is not specified.
@@ -78,11 +113,12 @@ public:
    * @return MutableTrajFile helper object to manipulate the bound NetCDF file.
    */
   static MutableTrajFile newFile(const std::string &filename,
-                                 bool replace = false) {
+                                 bool replace = false, bool isChunked = false,
+                                 const TrajStorage &storage = TrajStorage()) {
     if (replace)
-      return MutableTrajFile(filename, NcFile::replace);
+      return MutableTrajFile(filename, NcFile::replace, isChunked, storage);
     else
-      return MutableTrajFile(filename, NcFile::newFile);
+      return MutableTrajFile(filename, NcFile::newFile, isChunked, storage);
   };
 
   ///////////////////////////////////////////////
@@ -176,11 +212,31 @@ public:
     // double_array_t = traj_group.getType(DOUBLE_ARR);
 
     time_var = traj_group.getVar(TIME_VAR);
-    topo_var = traj_group.getVar(TOPO_VAR);
-    coord_var = traj_group.getVar(COORD_VAR);
-    phi_var = traj_group.getVar(PHI_VAR);
-    vel_var = traj_group.getVar(VEL_VAR);
-    extF_var = traj_group.getVar(EXTF_VAR);
+
+    std::string layout;
+    const auto atts = traj_group.getAtts();
+    if (atts.count(LAYOUT_NAME) != 0)
+      atts.find(LAYOUT_NAME)->second.getValues(layout);
+    isChunked = (layout == CHUNKED_LAYOUT_VALUE);
+    if (isChunked) {
+      epoch_var = traj_group.getVar(EPOCH_VAR);
+      loadEpochs();
+    } else {
+      topo_var = traj_group.getVar(TOPO_VAR);
+      // null for files written before topology references
+      topo_frame_var = traj_group.getVar(TOPO_REF_VAR);
+      isTopologyWritten = nFrames() != 0;
+      if (isTopologyWritten)
+        lastTopologyFrame = getTopologyFrame(nFrames() - 1);
+      coord_var = traj_group.getVar(COORD_VAR);
+      phi_var = traj_group.getVar(PHI_VAR);
+      vel_var = traj_group.getVar(VEL_VAR);
+      extF_var = traj_group.getVar(EXTF_VAR);
+      storage.coordinates = vlenStorage(coord_var);
+      storage.proteinDensity = vlenStorage(phi_var);
+      storage.velocity = vlenStorage(vel_var);
+      storage.externalForce = vlenStorage(extF_var);
+    }
   }
 
   /**
@@ -188,14 +244,21 @@ public:
    *
    * @param filename  Path to file to create
    * @param fMode     Mode to create the file
+   * @param isChunked_  Whether to store the per-vertex data of each run of
+   * frames with constant topology in fixed shape, chunked and compressed
+   * variables instead of vlen arrays, which can not be compressed
+   * @param storage_  Storage precision of the per-vertex variables
    */
-  void createNewFile(const std::string &filename,
-                     const NcFile::FileMode fMode) {
+  void createNewFile(const std::string &filename, const NcFile::FileMode fMode,
+                     const bool isChunked_ = false,
+                     const TrajStorage &storage_ = TrajStorage()) {
     if (fd != nullptr) {
       mem3dg_runtime_error("Cannot open an already open ...");
     }
 
     writeable = true;
+    isChunked = isChunked_;
+    storage = storage_;
 
     fd = new NcFile(filename, fMode);
     initializeConventions();
@@ -248,12 +311,23 @@ public:
     frame_dim = nc::NcDim{};
     uint_array_t = nc::NcVlenType{};
     double_array_t = nc::NcVlenType{};
+    float_array_t = nc::NcVlenType{};
+    short_array_t = nc::NcVlenType{};
+    storage = TrajStorage();
     time_var = nc::NcVar{};
     topo_var = nc::NcVar{};
+    topo_frame_var = nc::NcVar{};
+    lastTopologyFrame = 0;
+    isTopologyWritten = false;
     coord_var = nc::NcVar{};
     phi_var = nc::NcVar{};
     vel_var = nc::NcVar{};
     extF_var = nc::NcVar{};
+    epoch_var = nc::NcVar{};
+    epochs.clear();
+    epochTopology.resize(0, 3);
+    nTopologyFrames = 0;
+    isChunked = false;
     filename = "";
   }
 
@@ -271,6 +345,28 @@ public:
    */
   std::size_t nFrames() const { return frame_dim.getSize(); };
 
+  /**
+   * @brief Check if the per-vertex data is stored in the chunked layout
+   *
+   * @return True if chunked
+   */
+  bool isChunkedLayout() const { return isChunked; };
+
+  /**
+   * @brief Get the storage precision of the per-vertex variables
+   *
+   * @return TrajStorage  Storage of the variables
+   */
+  const TrajStorage &getStorage() const { return storage; };
+
+  /**
+   * @brief Get the number of runs of frames with constant topology in the
+   * chunked layout
+   *
+   * @return std::size_t Number of topology epochs
+   */
+  std::size_t nEpochs() const { return epochs.size(); };
+
   /**
    * @brief Netcdf file frame reader
    *
@@ -294,7 +390,15 @@ public:
    * @param data  Topology matrix
    */
   void writeTopology(const std::size_t idx, const EigenVectorX3ur &data) {
-    writeVar<std::uint32_t, 3>(topo_var, idx, data);
+    if (isChunked) {
+      writeEpochTopology(idx, data);
+    } else {
+      writeVar<std::uint32_t, 3>(topo_var, idx, data);
+      if (!topo_frame_var.isNull())
+        writeVar(topo_frame_var, idx, static_cast<unsigned long long>(idx));
+      lastTopologyFrame = idx;
+      isTopologyWritten = true;
+    }
   }
 
   /**
@@ -304,19 +408,64 @@ public:
    * @param data  Surface mesh
    */
   void writeTopology(const std::size_t idx, gc::SurfaceMesh &mesh) {
-    writeVar<std::uint32_t, 3>(
-        topo_var, idx,
-        EigenVectorX3ur{mesh.getFaceVertexMatrix<std::uint32_t>()});
+    writeTopology(idx,
+                  EigenVectorX3ur{mesh.getFaceVertexMatrix<std::uint32_t>()});
+  }
+
+  /**
+   * @brief Mark a frame to share the topology last written, without storing
+   * the topology again
+   *
+   * @param idx   Index of the frame
+   */
+  void writeTopologyReference(const std::size_t idx);
+
+  /**
+   * @brief Get the index of the frame that stores the topology of a frame
+   *
+   * @param idx     Index of the frame
+   * @return std::size_t  Index of the frame storing the topology
+   */
+  std::size_t getTopologyFrame(const std::size_t idx) const {
+    if (isChunked)
+      return getEpoch(idx).start;
+    if (topo_frame_var.isNull())
+      return idx;
+    return getVar<unsigned long long>(topo_frame_var, idx);
   }
 
   /**
-   * @brief Get the Topology object
+   * @brief Get the Topology object, resolving frames that reference the
+   * topology of an earlier frame
    *
    * @param idx
    * @return EigenVectorX3ur
    */
   EigenVectorX3ur getTopology(const std::size_t idx) const {
-    return getVar<std::uint32_t, POLYGON_ORDER>(topo_var, idx);
+    if (isChunked) {
+      const Epoch &epoch = getEpoch(idx);
+      EigenVectorX3ur topology(epoch.topo_var.getDim(0).getSize(),
+                               POLYGON_ORDER);
+      epoch.topo_var.getVar(topology.data());
+      return topology;
+    }
+    return getVar<std::uint32_t, POLYGON_ORDER>(topo_var,
+                                                getTopologyFrame(idx));
+  }
+
+  /**
+   * @brief Get the number of vertices of a given frame, to size the buffers
+   * of the frame readers. Only needed when getTopologyFrame(idx) changes
+   *
+   * @param idx           Index of the frame
+   * @return std::size_t  Number of vertices
+   */
+  std::size_t getNVertices(const std::size_t idx) const {
+    if (isChunked)
+      return getEpoch(idx).nVertices;
+    VlenBuffer vlen;
+    coord_var.getVar({idx}, &vlen.data);
+    return vlen.data.len / SPATIAL_DIMS;
   }
 
   /**
@@ -326,7 +475,8 @@ public:
    * @param data  Coordinate matrix
    */
   void writeCoords(const std::size_t idx, const EigenVectorX3dr &data) {
-    writeVar<double, 3>(coord_var, idx, data);
+    writeField<3>(coord_var, &Epoch::coord_var, storage.coordinates, idx,
+                  data);
   }
 
   /**
@@ -337,7 +487,7 @@ public:
    */
   void writeCoords(const std::size_t idx,
                    const gc::VertexPositionGeometry &data) {
-    writeVar<gc::Vertex>(coord_var, idx, data.inputVertexPositions);
+    writeCoords(idx, EigenMap<double, 3>(data.inputVertexPositions));
   }
 
   /**
@@ -347,7 +497,29 @@ public:
    * @return EigenVectorX3dr  Coordinates data
    */
   EigenVectorX3dr getCoords(const std::size_t idx) {
-    return getVar<double, SPATIAL_DIMS>(coord_var, idx);
+    return getField<SPATIAL_DIMS>(coord_var, &Epoch::coord_var,
+                                  storage.coordinates, idx);
+  }
+
+  /**
+   * @brief Read the coordinates of a given frame into a buffer, which can be
+   * reused across frames of the same topology
+   *
+   * @param idx   Index of the frame
+   * @param out   Buffer of getNVertices(idx) rows
+   */
+  void getCoords(const std::size_t idx, Eigen::Ref<EigenVectorX3dr> out) const {
+    readField<3>(coord_var, &Epoch::coord_var, storage.coordinates, idx, out);
+  }
+
+  /**
+   * @brief Write the protein density for a frame
+   *
+   * @param idx   Index of the frame
+   * @param data  Protein density vector
+   */
+  void writeProteinDensity(const std::size_t idx, const EigenVectorX1d &data) {
+    writeField1d(phi_var, &Epoch::phi_var, storage.proteinDensity, idx, data);
   }
 
   /**
@@ -358,7 +530,7 @@ public:
    */
   void writeProteinDensity(const std::size_t idx,
                            const gc::MeshData<gc::Vertex, double> &data) {
-    writeVar(phi_var, idx, data);
+    writeProteinDensity(idx, data.raw());
   }
 
   /**
@@ -368,7 +540,18 @@ public:
    * @return EigenVectorX3dr  Coordinates data
    */
   EigenVectorX1d getProteinDensity(const std::size_t idx) {
-    return getVar1d<double>(phi_var, idx);
+    return getField1d(phi_var, &Epoch::phi_var, storage.proteinDensity, idx);
+  }
+
+  /**
+   * @brief Read the protein density of a given frame into a buffer
+   *
+   * @param idx   Index of the frame
+   * @param out   Buffer of getNVertices(idx) rows
+   */
+  void getProteinDensity(const std::size_t idx,
+                         Eigen::Ref<EigenVectorX1d> out) const {
+    readField1d(phi_var, &Epoch::phi_var, storage.proteinDensity, idx, out);
   }
 
   /**
@@ -378,7 +561,7 @@ public:
    * @param data  Velocity matrix
    */
   void writeVelocity(const std::size_t idx, const EigenVectorX3dr &data) {
-    writeVar<double, 3>(vel_var, idx, data);
+    writeField<3>(vel_var, &Epoch::vel_var, storage.velocity, idx, data);
   }
 
   /**
@@ -389,7 +572,7 @@ public:
    */
   void writeVelocity(const std::size_t idx,
                      const gcs::VertexData<gc::Vector3> &data) {
-    writeVar<gc::Vertex>(vel_var, idx, data);
+    writeVelocity(idx, EigenMap<double, 3>(data));
   }
 
   /**
@@ -399,7 +582,19 @@ public:
    * @return EigenVectorX3dr  Velocity data
    */
   EigenVectorX3dr getVelocity(const std::size_t idx) const {
-    return getVar<double, SPATIAL_DIMS>(vel_var, idx);
+    return getField<SPATIAL_DIMS>(vel_var, &Epoch::vel_var, storage.velocity,
+                                  idx);
+  }
+
+  /**
+   * @brief Read the velocities of a given frame into a buffer
+   *
+   * @param idx   Index of the frame
+   * @param out   Buffer of getNVertices(idx) rows
+   */
+  void getVelocity(const std::size_t idx,
+                   Eigen::Ref<EigenVectorX3dr> out) const {
+    readField<3>(vel_var, &Epoch::vel_var, storage.velocity, idx, out);
   }
 
   /**
@@ -409,7 +604,7 @@ public:
    * @param data  Velocity matrix
    */
   void writeExternalForce(const std::size_t idx, const EigenVectorX3dr &data) {
-    writeVar<double, 3>(extF_var, idx, data);
+    writeField<3>(extF_var, &Epoch::extF_var, storage.externalForce, idx, data);
   }
 
   /**
@@ -420,7 +615,7 @@ public:
    */
   void writeExternalForce(const std::size_t idx,
                           const gcs::VertexData<gc::Vector3> &data) {
-    writeVar<gc::Vertex>(extF_var, idx, data);
+    writeExternalForce(idx, EigenMap<double, 3>(data));
   }
 
   /**
@@ -430,7 +625,19 @@ public:
    * @return EigenVectorX3dr  Velocity data
    */
   EigenVectorX3dr getExternalForce(const std::size_t idx) const {
-    return getVar<double, SPATIAL_DIMS>(extF_var, idx);
+    return getField<SPATIAL_DIMS>(extF_var, &Epoch::extF_var,
+                                  storage.externalForce, idx);
+  }
+
+  /**
+   * @brief Read the external force field of a given frame into a buffer
+   *
+   * @param idx   Index of the frame
+   * @param out   Buffer of getNVertices(idx) rows
+   */
+  void getExternalForce(const std::size_t idx,
+                        Eigen::Ref<EigenVectorX3dr> out) const {
+    readField<3>(extF_var, &Epoch::extF_var, storage.externalForce, idx, out);
   }
 
   /**
@@ -569,14 +776,14 @@ private:
                                 const std::size_t idx) const {
     assert(idx < nFrames());
 
-    nc_vlen_t vlenData;
-    var.getVar({idx}, &vlenData);
+    VlenBuffer vlen;
+    var.getVar({idx}, &vlen.data);
 
     // Initialize an Eigen object and copy the data over
-    EigenVectorXkr_T<T, k> vec(vlenData.len / k, k);
+    EigenVectorXkr_T<T, k> vec(vlen.data.len / k, k);
     // Bind to nc_vlen_t memory and copy data over
-    vec = AlignedEigenMap_T<T, k, Eigen::RowMajor>(static_cast<T *>(vlenData.p),
-                                                   vlenData.len / k, k);
+    vec = AlignedEigenMap_T<T, k, Eigen::RowMajor>(
+        static_cast<T *>(vlen.data.p), vlen.data.len / k, k);
     return vec;
   }
 
@@ -585,16 +792,60 @@ private:
                                 const std::size_t idx) const {
     assert(idx < nFrames());
 
-    nc_vlen_t vlenData;
-    var.getVar({idx}, &vlenData);
+    VlenBuffer vlen;
+    var.getVar({idx}, &vlen.data);
 
     // Initialize an Eigen object and copy the data over
-    EigenVectorX1_T<T> vec(vlenData.len);
+    EigenVectorX1_T<T> vec(vlen.data.len);
     // Bind to nc_vlen_t memory and copy data over
-    vec = AlignedEigenMap_T<T, 1, Eigen::ColMajor>(static_cast<T *>(vlenData.p), vlenData.len);
+    vec = AlignedEigenMap_T<T, 1, Eigen::ColMajor>(
+        static_cast<T *>(vlen.data.p), vlen.data.len);
     return vec;
   }
 
+  /**
+   * @brief Read a vlen matrix of a frame stored as T into a caller provided
+   * buffer
+   *
+   * @param var   Vlen variable
+   * @param idx   Index of the frame
+   * @param out   Buffer of the size of the frame
+   */
+  template <typename T, int k>
+  void readVar(const nc::NcVar &var, const std::size_t idx,
+               Eigen::Ref<EigenVectorXkr_T<double, k>> out) const {
+    assert(idx < nFrames());
+
+    VlenBuffer vlen;
+    var.getVar({idx}, &vlen.data);
+    if (vlen.data.len != std::size_t(out.size()))
+      mem3dg_runtime_error("Buffer does not match the size of the frame!");
+    out = Eigen::Map<const EigenVectorXkr_T<T, k>>(
+              static_cast<const T *>(vlen.data.p), out.rows(), k)
+              .template cast<double>();
+  }
+
+  /**
+   * @brief Read a vlen vector of a frame stored as T into a caller provided
+   * buffer
+   *
+   * @param var   Vlen variable
+   * @param idx   Index of the frame
+   * @param out   Buffer of the size of the frame
+   */
+  template <typename T>
+  void readVar1d(const nc::NcVar &var, const std::size_t idx,
+                 Eigen::Ref<EigenVectorX1d> out) const {
+    assert(idx < nFrames());
+
+    VlenBuffer vlen;
+    var.getVar({idx}, &vlen.data);
+    if (vlen.data.len != std::size_t(out.size()))
+      mem3dg_runtime_error("Buffer does not match the size of the frame!");
+    out = Eigen::Map<const EigenVectorX1_T<T>>(
+              static_cast<const T *>(vlen.data.p), out.size())
+              .template cast<double>();
+  }
 
   template <typename T,
             typename = std::enable_if_t<std::is_fundamental<T>::value>>
@@ -607,6 +858,318 @@ private:
     return data;
   }
 
+  /**
+   * @brief Find the topology epoch of a frame in the chunked layout
+   *
+   * @param idx     Index of the frame
+   * @return Epoch  Topology epoch containing the frame
+   */
+  const Epoch &getEpoch(const std::size_t idx) const {
+    if (idx >= nTopologyFrames)
+      mem3dg_runtime_error("The topology of a frame has to be written before "
+                           "its vertex data in the chunked layout!");
+    auto it = std::upper_bound(
+        epochs.begin(), epochs.end(), idx,
+        [](std::size_t i, const Epoch &epoch) { return i < epoch.start; });
+    return *(it - 1);
+  }
+
+  /**
+   * @brief Start a new topology epoch at a frame, or continue the current one
+   * if the topology is unchanged, and record the epoch of the frame
+   *
+   * @param idx   Index of the frame
+   * @param data  Topology matrix
+   */
+  void writeEpochTopology(const std::size_t idx, const EigenVectorX3ur &data);
+
+  /**
+   * @brief Add the group and the fixed shape variables of a topology epoch
+   *
+   * @param start     First frame of the epoch
+   * @param topology  Topology matrix of the epoch
+   */
+  void addEpoch(const std::size_t start, const EigenVectorX3ur &topology);
+
+  /**
+   * @brief Bind the topology epochs of an existing file
+   */
+  void loadEpochs();
+
+  /**
+   * @brief Write a frame of a per-vertex matrix in the chunked layout
+   */
+  template <typename T, int k>
+  void writeEpochVar(nc::NcVar Epoch::*var, const std::size_t idx,
+                     const EigenVectorXkr_T<T, k> &data) {
+    if (!writeable)
+      mem3dg_runtime_error("Cannot write to read only file.");
+    const Epoch &epoch = getEpoch(idx);
+    if (std::size_t(data.rows()) != epoch.nVertices)
+      mem3dg_runtime_error("Data does not match the topology of the frame!");
+    (epoch.*var).putVar({idx - epoch.start, 0, 0},
+                        {1, epoch.nVertices, std::size_t(k)}, data.data());
+  }
+
+  /**
+   * @brief Write a frame of a per-vertex vector in the chunked layout
+   */
+  template <typename T>
+  void writeEpochVar1d(nc::NcVar Epoch::*var, const std::size_t idx,
+                       const EigenVectorX1_T<T> &data) {
+    if (!writeable)
+      mem3dg_runtime_error("Cannot write to read only file.");
+    const Epoch &epoch = getEpoch(idx);
+    if (std::size_t(data.rows()) != epoch.nVertices)
+      mem3dg_runtime_error("Data does not match the topology of the frame!");
+    (epoch.*var).putVar({idx - epoch.start, 0}, {1, epoch.nVertices},
+                        data.data());
+  }
+
+  /**
+   * @brief Read a frame of a per-vertex matrix in the chunked layout, only
+   * the chunk of the frame is decompressed
+   */
+  template <typename T, std::size_t k>
+  EigenVectorXkr_T<T, k> getEpochVar(nc::NcVar Epoch::*var,
+                                     const std::size_t idx) const {
+    assert(idx < nFrames());
+    const Epoch &epoch = getEpoch(idx);
+    EigenVectorXkr_T<T, k> vec(epoch.nVertices, k);
+    (epoch.*var).getVar({idx - epoch.start, 0, 0}, {1, epoch.nVertices, k},
+                        vec.data());
+    return vec;
+  }
+
+  /**
+   * @brief Read a frame of a per-vertex vector in the chunked layout
+   */
+  template <typename T>
+  EigenVectorX1_T<T> getEpochVar1d(nc::NcVar Epoch::*var,
+                                   const std::size_t idx) const {
+    assert(idx < nFrames());
+    const Epoch &epoch = getEpoch(idx);
+    EigenVectorX1_T<T> vec(epoch.nVertices);
+    (epoch.*var).getVar({idx - epoch.start, 0}, {1, epoch.nVertices},
+                        vec.data());
+    return vec;
+  }
+
+  /**
+   * @brief Read a frame of a per-vertex matrix in the chunked layout into a
+   * caller provided buffer, directly if the buffer is contiguous
+   */
+  template <typename T, int k>
+  void readEpochVar(nc::NcVar Epoch::*var, const std::size_t idx,
+                    Eigen::Ref<EigenVectorXkr_T<T, k>> out) const {
+    assert(idx < nFrames());
+    const Epoch &epoch = getEpoch(idx);
+    if (std::size_t(out.rows()) != epoch.nVertices)
+      mem3dg_runtime_error("Buffer does not match the size of the frame!");
+    if (out.outerStride() == k) {
+      (epoch.*var).getVar({idx - epoch.start, 0, 0},
+                          {1, epoch.nVertices, std::size_t(k)}, out.data());
+    } else {
+      out = getEpochVar<T, k>(var, idx);
+    }
+  }
+
+  /**
+   * @brief Read a frame of a per-vertex vector in the chunked layout into a
+   * caller provided buffer
+   */
+  template <typename T>
+  void readEpochVar1d(nc::NcVar Epoch::*var, const std::size_t idx,
+                      Eigen::Ref<EigenVectorX1_T<T>> out) const {
+    assert(idx < nFrames());
+    const Epoch &epoch = getEpoch(idx);
+    if (std::size_t(out.rows()) != epoch.nVertices)
+      mem3dg_runtime_error("Buffer does not match the size of the frame!");
+    (epoch.*var).getVar({idx - epoch.start, 0}, {1, epoch.nVertices},
+                        out.data());
+  }
+
+  /**
+   * @brief Write a frame of a per-vertex matrix stored as T in the layout of
+   * the file
+   */
+  template <typename T, int k>
+  void writeStored(nc::NcVar &var, nc::NcVar Epoch::*epochVar,
+                   const std::size_t idx, const EigenVectorXkr_T<T, k> &data) {
+    if (isChunked)
+      writeEpochVar<T, k>(epochVar, idx, data);
+    else
+      writeVar<T, k>(var, idx, data);
+  }
+
+  /**
+   * @brief Write a frame of a per-vertex vector stored as T in the layout of
+   * the file
+   */
+  template <typename T>
+  void writeStored1d(nc::NcVar &var, nc::NcVar Epoch::*epochVar,
+                     const std::size_t idx, const EigenVectorX1_T<T> &data) {
+    if (isChunked)
+      writeEpochVar1d<T>(epochVar, idx, data);
+    else
+      writeVar<T>(var, idx, data);
+  }
+
+  /**
+   * @brief Write a frame of a per-vertex matrix in its storage precision
+   *
+   * @param var       vlen variable
+   * @param epochVar  variable of the chunked layout
+   * @param varStorage  storage of the variable
+   * @param idx       index of the frame
+   * @param data      data of the frame
+   */
+  template <int k>
+  void writeField(nc::NcVar &var, nc::NcVar Epoch::*epochVar,
+                  const VariableStorage &varStorage, const std::size_t idx,
+                  const EigenVectorXkr_T<double, k> &data) {
+    switch (varStorage.precision) {
+    case StoragePrecision::Float:
+      writeStored<float, k>(var, epochVar, idx,
+                            data.template cast<float>().eval());
+      break;
+    case StoragePrecision::Int16:
+      writeStored<std::int16_t, k>(
+          var, epochVar, idx,
+          varStorage.pack<EigenVectorXkr_T<std::int16_t, k>>(data));
+      break;
+    default:
+      writeStored<double, k>(var, epochVar, idx, data);
+    }
+  }
+
+  /**
+   * @brief Write a frame of a per-vertex vector in its storage precision
+   */
+  void writeField1d(nc::NcVar &var, nc::NcVar Epoch::*epochVar,
+                    const VariableStorage &varStorage, const std::size_t idx,
+                    const EigenVectorX1d &data) {
+    switch (varStorage.precision) {
+    case StoragePrecision::Float:
+      writeStored1d<float>(var, epochVar, idx, data.cast<float>().eval());
+      break;
+    case StoragePrecision::Int16:
+      writeStored1d<std::int16_t>(
+          var, epochVar, idx,
+          varStorage.pack<EigenVectorX1_T<std::int16_t>>(data));
+      break;
+    default:
+      writeStored1d<double>(var, epochVar, idx, data);
+    }
+  }
+
+  /**
+   * @brief Read a frame of a per-vertex matrix as doubles
+   */
+  template <int k>
+  EigenVectorXkr_T<double, k> getField(const nc::NcVar &var,
+                                       nc::NcVar Epoch::*epochVar,
+                                       const VariableStorage &varStorage,
+                                       const std::size_t idx) const {
+    EigenVectorXkr_T<double, k> data;
+    if (isChunked) {
+      // netCDF converts fixed shape variables to double
+      data = getEpochVar<double, k>(epochVar, idx);
+    } else if (varStorage.precision == StoragePrecision::Float) {
+      data = getVar<float, k>(var, idx).template cast<double>();
+    } else if (varStorage.precision == StoragePrecision::Int16) {
+      data = getVar<std::int16_t, k>(var, idx).template cast<double>();
+    } else {
+      return getVar<double, k>(var, idx);
+    }
+    varStorage.unpack(data);
+    return data;
+  }
+
+  /**
+   * @brief Read a frame of a per-vertex vector as doubles
+   */
+  EigenVectorX1d getField1d(const nc::NcVar &var, nc::NcVar Epoch::*epochVar,
+                            const VariableStorage &varStorage,
+                            const std::size_t idx) const {
+    EigenVectorX1d data;
+    if (isChunked) {
+      data = getEpochVar1d<double>(epochVar, idx);
+    } else if (varStorage.precision == StoragePrecision::Float) {
+      data = getVar1d<float>(var, idx).cast<double>();
+    } else if (varStorage.precision == StoragePrecision::Int16) {
+      data = getVar1d<std::int16_t>(var, idx).cast<double>();
+    } else {
+      return getVar1d<double>(var, idx);
+    }
+    varStorage.unpack(data);
+    return data;
+  }
+
+  /**
+   * @brief Read a frame of a per-vertex matrix as doubles into a buffer
+   */
+  template <int k>
+  void readField(const nc::NcVar &var, nc::NcVar Epoch::*epochVar,
+                 const VariableStorage &varStorage, const std::size_t idx,
+                 Eigen::Ref<EigenVectorXkr_T<double, k>> out) const {
+    if (isChunked)
+      readEpochVar<double, k>(epochVar, idx, out);
+    else if (varStorage.precision == StoragePrecision::Float)
+      readVar<float, k>(var, idx, out);
+    else if (varStorage.precision == StoragePrecision::Int16)
+      readVar<std::int16_t, k>(var, idx, out);
+    else
+      readVar<double, k>(var, idx, out);
+    varStorage.unpack(out);
+  }
+
+  /**
+   * @brief Read a frame of a per-vertex vector as doubles into a buffer
+   */
+  void readField1d(const nc::NcVar &var, nc::NcVar Epoch::*epochVar,
+                   const VariableStorage &varStorage, const std::size_t idx,
+                   Eigen::Ref<EigenVectorX1d> out) const {
+    if (isChunked)
+      readEpochVar1d<double>(epochVar, idx, out);
+    else if (varStorage.precision == StoragePrecision::Float)
+      readVar1d<float>(var, idx, out);
+    else if (varStorage.precision == StoragePrecision::Int16)
+      readVar1d<std::int16_t>(var, idx, out);
+    else
+      readVar1d<double>(var, idx, out);
+    varStorage.unpack(out);
+  }
+
+  /**
+   * @brief Get the vlen array type of a storage precision, added to the
+   * trajectory group on first use
+   */
+  nc::NcVlenType vlenArrayType(const VariableStorage &varStorage) {
+    switch (varStorage.precision) {
+    case StoragePrecision::Float:
+      if (float_array_t.isNull())
+        float_array_t = traj_group.addVlenType(FLOAT_ARR, nc::ncFloat);
+      return float_array_t;
+    case StoragePrecision::Int16:
+      if (short_array_t.isNull())
+        short_array_t = traj_group.addVlenType(SHORT_ARR, nc::ncShort);
+      return short_array_t;
+    default:
+      if (double_array_t.isNull())
+        double_array_t = traj_group.addVlenType(DOUBLE_ARR, nc::ncDouble);
+      return double_array_t;
+    }
+  }
+
+  /**
+   * @brief Get the storage of an existing vlen variable
+   */
+  static VariableStorage vlenStorage(const nc::NcVar &var) {
+    return VariableStorage::fromVariable(
+        var, nc::NcVlenType(var.getType()).getBaseType());
+  }
+
   /**
    * @brief Private constructor for opening or creating a new NetCDF file.
    *
@@ -614,13 +1177,17 @@ private:
    *
    * @param filename Path to file of interest
    * @param fMode    Mode to open/create file with
+   * @param isChunked_ Whether to use the chunked layout for a new file
+   * @param storage_   Storage precision of a new file
    */
-  MutableTrajFile(const std::string &filename, const NcFile::FileMode fMode)
+  MutableTrajFile(const std::string &filename, const NcFile::FileMode fMode,
+                  const bool isChunked_ = false,
+                  const TrajStorage &storage_ = TrajStorage())
       : filename(filename), fd(nullptr), writeable(fMode != NcFile::read) {
     if (fMode == NcFile::read || fMode == NcFile::write)
       open(filename, fMode);
     else
-      createNewFile(filename, fMode);
+      createNewFile(filename, fMode, isChunked_, storage_);
   }
 
   ///////////////////////////////////////////////
@@ -660,19 +1227,37 @@ private:
     time_var.putAtt(UNITS, TIME_UNITS);
     time_var.setCompression(true, true, compression_level);
 
+    // per-vertex variables are added with each topology epoch
+    if (isChunked) {
+      traj_group.putAtt(LAYOUT_NAME, CHUNKED_LAYOUT_VALUE);
+      epoch_var = traj_group.addVar(EPOCH_VAR, nc::ncUint, {frame_dim});
+      epoch_var.setCompression(true, true, compression_level);
+      return;
+    }
+
     uint_array_t = traj_group.addVlenType(UINT_ARR, nc::ncUint);
-    double_array_t = traj_group.addVlenType(DOUBLE_ARR, nc::ncDouble);
 
     topo_var = traj_group.addVar(TOPO_VAR, uint_array_t, {frame_dim});
     topo_var.setCompression(true, true, compression_level);
-    coord_var = traj_group.addVar(COORD_VAR, double_array_t, {frame_dim});
+    topo_frame_var =
+        traj_group.addVar(TOPO_REF_VAR, nc::ncUint64, {frame_dim});
+    topo_frame_var.setCompression(true, true, compression_level);
+    coord_var = traj_group.addVar(
+        COORD_VAR, vlenArrayType(storage.coordinates), {frame_dim});
     coord_var.setCompression(true, true, compression_level);
-    phi_var = traj_group.addVar(PHI_VAR, double_array_t, {frame_dim});
+    storage.coordinates.putAttributes(coord_var);
+    phi_var = traj_group.addVar(
+        PHI_VAR, vlenArrayType(storage.proteinDensity), {frame_dim});
     phi_var.setCompression(true, true, compression_level);
-    vel_var = traj_group.addVar(VEL_VAR, double_array_t, {frame_dim});
+    storage.proteinDensity.putAttributes(phi_var);
+    vel_var = traj_group.addVar(VEL_VAR, vlenArrayType(storage.velocity),
+                                {frame_dim});
     vel_var.setCompression(true, true, compression_level);
-    extF_var = traj_group.addVar(EXTF_VAR, double_array_t, {frame_dim});
+    storage.velocity.putAttributes(vel_var);
+    extF_var = traj_group.addVar(
+        EXTF_VAR, vlenArrayType(storage.externalForce), {frame_dim});
     extF_var.setCompression(true, true, compression_level);
+    storage.externalForce.putAttributes(extF_var);
   }
 
   /// Bound NcFile
@@ -687,12 +1272,23 @@ private:
   /// Variable length type for topology
   nc::NcVlenType uint_array_t;
   nc::NcVlenType double_array_t;
+  nc::NcVlenType float_array_t;
+  nc::NcVlenType short_array_t;
+
+  /// Storage precision of the per-vertex variables
+  TrajStorage storage;
 
   /// Variable for storing time
   nc::NcVar time_var;
 
   /// Vlen variable for topology
   nc::NcVar topo_var;
+  /// Variable for storing the frame holding the topology of each frame
+  nc::NcVar topo_frame_var;
+  /// Last frame with stored topology
+  std::size_t lastTopologyFrame = 0;
+  /// Whether any topology has been stored
+  bool isTopologyWritten = false;
   /// Vlen variable for coordinates
   nc::NcVar coord_var;
   /// Vlen variable for protein density
@@ -702,6 +1298,18 @@ private:
   /// Vlen variable for external forces
   nc::NcVar extF_var;
 
+  /// whether per-vertex data is stored in fixed shape, chunked variables per
+  /// topology epoch instead of vlen arrays
+  bool isChunked = false;
+  /// Variable for storing the topology epoch of each frame
+  nc::NcVar epoch_var;
+  /// Topology epochs in order of frames
+  std::vector<Epoch> epochs;
+  /// Topology of the last epoch
+  EigenVectorX3ur epochTopology;
+  /// Number of frames with recorded topology epoch
+  std::size_t nTopologyFrames = 0;
+
   /// Filepath to file
   std::string filename;
   /// Writeable status
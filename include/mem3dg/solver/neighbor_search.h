@@ -0,0 +1,75 @@
+// Membrane Dynamics in 3D using Discrete Differential Geometry (Mem3DG)
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Copyright (c) 2020:
+//     Laboratory for Computational Cellular Mechanobiology
+//     Cuncheng Zhu (cuzhu@eng.ucsd.edu)
+//     Christopher T. Lee (ctlee@ucsd.edu)
+//     Ravi Ramamoorthi (ravir@cs.ucsd.edu)
+//     Padmini Rangamani (prangamani@eng.ucsd.edu)
+//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "mem3dg/macros.h"
+#include "mem3dg/type_utilities.h"
+
+namespace mem3dg {
+namespace solver {
+
+/**
+ * @brief Uniform grid (cell list) used to find all pairs of points closer than
+ * a cutoff distance in O(N) instead of O(N^2)
+ */
+class DLL_PUBLIC CellList {
+public:
+  /**
+   * @brief Bin the points into cubic cells of edge length equal to the cutoff
+   *
+   * @param positions   point coordinates, N x 3
+   * @param cutoff      search radius, has to be positive
+   */
+  void build(const Eigen::Ref<const EigenVectorX3dr> &positions,
+             double cutoff);
+
+  /**
+   * @brief Find all pairs (i, j), i < j, closer than the cutoff. Pairs are
+   * sorted lexicographically so that accumulation order is deterministic
+   *
+   * @param pairs       output list of pairs, overwritten
+   */
+  void findPairs(std::vector<std::pair<std::size_t, std::size_t>> &pairs) const;
+
+  /// search radius and edge length of the cells
+  double cutoff = 0;
+
+private:
+  /// packed integer key of the cell at grid coordinate (x, y, z)
+  static std::uint64_t cellKey(std::int64_t x, std::int64_t y, std::int64_t z);
+
+  /// cached point coordinates
+  EigenVectorX3dr points;
+  /// lower corner of the grid
+  Eigen::Vector3d origin;
+  /// grid coordinate of the cell of each point
+  Eigen::Matrix<std::int64_t, Eigen::Dynamic, 3, Eigen::RowMajor> pointCells;
+  /// point indices sorted by cell
+  std::vector<std::size_t> sortedPoints;
+  /// range in sortedPoints occupied by each nonempty cell
+  std::unordered_map<std::uint64_t, std::pair<std::size_t, std::size_t>>
+      cellRanges;
+};
+
+} // namespace solver
+} // namespace mem3dg
@@ -31,6 +31,7 @@
 #include <pcg_random.hpp>
 #include <random>
 
+#include <cstdint>
 #include <math.h>
 #include <vector>
 
@@ -136,6 +137,17 @@ struct Parameters {
     std::size_t n = 1;
     // period factor of computation
     double p = 0;
+    /// cutoff distance of the cell list neighbor search, 0 for all pairs
+    double cutoff = 0;
+    /// Barnes-Hut opening angle of the far field approximation, 0 for exact.
+    /// The projected collision time is then only estimated within the cutoff;
+    /// without a cutoff it is 0 and the force is updated every step
+    double theta = 0;
+
+    /**
+     * @brief check parameter conflicts
+     */
+    void checkParameters();
   };
 
   struct External {
@@ -146,6 +158,8 @@ struct Parameters {
   struct DPD {
     /// Dissipation coefficient
     double gamma = 0;
+    /// Seed of the random noise, negative to seed from std::random_device
+    std::int64_t seed = -1;
   };
 
   struct Boundary {
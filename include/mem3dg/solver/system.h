@@ -44,8 +44,12 @@
 #include "mem3dg/macros.h"
 #include "mem3dg/mesh_io.h"
 #include "mem3dg/meshops.h"
+#include "mem3dg/solver/barnes_hut.h"
+#include "mem3dg/solver/counter_rng.h"
 #include "mem3dg/solver/forces.h"
+#include "mem3dg/solver/geometry_kernel.h"
 #include "mem3dg/solver/mesh_process.h"
+#include "mem3dg/solver/neighbor_search.h"
 #include "mem3dg/solver/parameters.h"
 #include "mem3dg/type_utilities.h"
 
@@ -87,6 +91,36 @@ struct Energy {
   double selfAvoidancePenalty = 0;
 };
 
+/**
+ * @brief Bitmask of the optional terms of the mechanical force kernel. Bending,
+ * tension and pressure are always assembled
+ */
+namespace MechanicalTerm {
+enum : unsigned {
+  Deviatoric = 1 << 0,
+  Dirichlet = 1 << 1,
+  Adsorption = 1 << 2,
+  Aggregation = 1 << 3,
+  All = (1 << 4) - 1
+};
+} // namespace MechanicalTerm
+
+/**
+ * @brief Partial sums of the mechanical force components on a vertex
+ */
+struct MechanicalForceContribution {
+  gc::Vector3 bendingForceVec_areaGrad{0, 0, 0};
+  gc::Vector3 bendingForceVec_gaussVec{0, 0, 0};
+  gc::Vector3 bendingForceVec_schlafliVec{0, 0, 0};
+  gc::Vector3 deviatoricForceVec_mean{0, 0, 0};
+  gc::Vector3 deviatoricForceVec_gauss{0, 0, 0};
+  gc::Vector3 capillaryForceVec{0, 0, 0};
+  gc::Vector3 osmoticForceVec{0, 0, 0};
+  gc::Vector3 lineCapForceVec{0, 0, 0};
+  gc::Vector3 adsorptionForceVec{0, 0, 0};
+  gc::Vector3 aggregationForceVec{0, 0, 0};
+};
+
 class DLL_PUBLIC System {
 protected:
   /// Cached geodesic distance
@@ -94,6 +128,34 @@ protected:
   /// Random number engine
   pcg32 rng;
   std::normal_distribution<double> normal_dist;
+  /// Standard normal deviates of the DPD noise, one per edge
+  EigenVectorX1d dpdNoise;
+  /// Spatial grid for self-avoidance neighbor search
+  CellList cellList;
+  /// Octree for self-avoidance far field approximation
+  BarnesHutTree barnesHutTree;
+  /// Barnes-Hut self-avoidance potential of the cached configuration
+  EigenVectorX1d selfAvoidancePotential;
+  /// Barnes-Hut self-avoidance field of the cached configuration
+  EigenVectorX3dr selfAvoidanceField;
+  /// Vertex positions the self-avoidance field was evaluated on
+  EigenVectorX3dr selfAvoidanceFieldPositions;
+  /// Protein density the self-avoidance field was evaluated on
+  EigenVectorX1d selfAvoidanceFieldDensity;
+  /// Opening angle and limit distance the self-avoidance field was evaluated
+  /// with
+  double selfAvoidanceFieldTheta, selfAvoidanceFieldD;
+  /// Whether the exclusion table changed since the field was evaluated
+  bool isSelfAvoidanceFieldOutdated;
+  /// Optional geometric quantities currently required on vpg
+  unsigned requiredGeometricQuantities;
+  /// Fused computation of the geometric quantities
+  GeometryKernel geometryKernel;
+  /// Vertex positions at the last geometry refresh, empty if outdated
+  EigenVectorX3dr refreshedPositions;
+  /// Volume enclosed by the mesh at the last geometry refresh, excluding the
+  /// reservoir volume
+  double meshVolume;
 
 public:
   /// Parameters
@@ -129,6 +191,20 @@ public:
   gcs::VertexData<gc::Vector3> velocity;
   /// Cached vertex protein velocity
   gcs::VertexData<double> proteinVelocity;
+  /// Cached halfedge area gradient (twice the mean curvature vector)
+  gcs::HalfedgeData<gc::Vector3> halfedgeAreaGradient;
+  /// Cached halfedge Gaussian curvature vector
+  gcs::HalfedgeData<gc::Vector3> halfedgeGaussianCurvatureVector;
+  /// Cached edge length times dihedral angle gradient wrt the tail vertex
+  gcs::HalfedgeData<gc::Vector3> halfedgeSchlafliTail;
+  /// Cached edge length times dihedral angle gradient wrt the opposite vertex
+  gcs::HalfedgeData<gc::Vector3> halfedgeSchlafliOpposite;
+  /// Cached gradient of the angle at the halfedge corner wrt its tail vertex
+  gcs::HalfedgeData<gc::Vector3> halfedgeCornerGradientSelf;
+  /// Cached gradient of the angle at the next corner wrt the tail vertex
+  gcs::HalfedgeData<gc::Vector3> halfedgeCornerGradientNext;
+  /// Cached gradient of the angle at the halfedge corner wrt its tip vertex
+  gcs::HalfedgeData<gc::Vector3> halfedgeCornerGradientTip;
   /// Spontaneous curvature of the mesh
   gcs::VertexData<double> H0;
   /// Bending rigidity of the membrane
@@ -147,6 +223,39 @@ public:
   gcs::VertexData<bool> thePointTracker;
   /// projected time of collision
   double projectedCollideTime;
+  /// self-avoidance vertex pairs within cutoff, excluding neighborhood layers
+  std::vector<std::pair<std::size_t, std::size_t>> selfAvoidancePairs;
+  /// row offsets of the self-avoidance exclusion table, (N + 1) x 1
+  std::vector<std::size_t> selfAvoidanceExclusionStart;
+  /// sorted excluded neighbors j > i of each vertex i in compressed rows
+  std::vector<std::size_t> selfAvoidanceExclusions;
+  /// neighborhood layers the exclusion table was built with
+  std::size_t selfAvoidanceExclusionLayer;
+  /// whether topology changed since the exclusion table was built
+  bool isSelfAvoidanceExclusionOutdated;
+  /// optional geometric quantities to keep up to date regardless of the
+  /// active terms, e.g. GeometricQuantity::All to refresh everything
+  unsigned extraGeometricQuantities;
+  /// whether to refresh geometry with the fused kernel instead of
+  /// vpg->refreshQuantities()
+  bool isFusedGeometry;
+  /// whether topology changed since the fused geometry kernel was built
+  bool isGeometryKernelOutdated;
+  /// row offsets of the edge coloring, (number of colors + 1) x 1
+  std::vector<std::size_t> edgeColorStart;
+  /// edge indices grouped by color, edges of a color share no vertex
+  std::vector<std::size_t> coloredEdges;
+  /// whether topology changed since the edge coloring was built
+  bool isEdgeColoringOutdated;
+  /// whether topology changed since the integrator analyzed the sparsity
+  /// pattern of its preconditioner
+  bool isPreconditionerOutdated;
+  /// number of topology changes, bumped by edgeFlip and growMesh
+  std::uint64_t topologyVersion;
+  /// seed of the random number generators
+  std::uint64_t seed;
+  /// number of DPD noise samples drawn, counter of the DPD noise stream
+  std::uint64_t dpdStep;
 
   // ==========================================================
   // =============        Constructors           ==============
@@ -491,31 +600,48 @@ private:
     H0 = gcs::VertexData<double>(*mesh);
     Kb = gcs::VertexData<double>(*mesh);
     Kd = gcs::VertexData<double>(*mesh);
+    halfedgeAreaGradient = gcs::HalfedgeData<gc::Vector3>(*mesh, {0, 0, 0});
+    halfedgeGaussianCurvatureVector =
+        gcs::HalfedgeData<gc::Vector3>(*mesh, {0, 0, 0});
+    halfedgeSchlafliTail = gcs::HalfedgeData<gc::Vector3>(*mesh, {0, 0, 0});
+    halfedgeSchlafliOpposite =
+        gcs::HalfedgeData<gc::Vector3>(*mesh, {0, 0, 0});
+    halfedgeCornerGradientSelf =
+        gcs::HalfedgeData<gc::Vector3>(*mesh, {0, 0, 0});
+    halfedgeCornerGradientNext =
+        gcs::HalfedgeData<gc::Vector3>(*mesh, {0, 0, 0});
+    halfedgeCornerGradientTip =
+        gcs::HalfedgeData<gc::Vector3>(*mesh, {0, 0, 0});
 
     geodesicDistanceFromPtInd = gcs::VertexData<double>(*mesh, 0);
 
     isSmooth = true;
+    isSelfAvoidanceExclusionOutdated = true;
+    selfAvoidanceExclusionLayer = 0;
+    isSelfAvoidanceFieldOutdated = true;
+    isEdgeColoringOutdated = true;
+    isFusedGeometry = true;
+    isGeometryKernelOutdated = true;
+    isPreconditionerOutdated = true;
+    topologyVersion = 0;
     mutationMarker = gc::VertexData<bool>(*mesh, false);
     thePointTracker = gc::VertexData<bool>(*mesh, false);
 
-    // GC computed properties
+    // GC computed properties, the optional ones are required in
+    // updateConfigurations once parameters are known
+    requiredGeometricQuantities = 0;
+    extraGeometricQuantities = 0;
     vpg->requireFaceNormals();
-    vpg->requireVertexLumpedMassMatrix();
-    vpg->requireCotanLaplacian();
     vpg->requireFaceAreas();
     vpg->requireVertexIndices();
-    vpg->requireVertexGaussianCurvatures();
     vpg->requireVertexMeanCurvatures();
     vpg->requireFaceIndices();
     vpg->requireEdgeLengths();
     vpg->requireVertexNormals();
     vpg->requireVertexDualAreas();
     vpg->requireCornerAngles();
-    vpg->requireCornerScaledAngles();
-    vpg->requireDECOperators();
     vpg->requireEdgeDihedralAngles();
     vpg->requireHalfedgeCotanWeights();
-    vpg->requireEdgeCotanWeights();
     // vpg->requireVertexTangentBasis();
   }
 
@@ -528,23 +654,18 @@ public:
    * elsewhere, calculation of dependent quantities should be respected.
    */
   ~System() {
+    requireGeometricQuantities(0);
     vpg->unrequireFaceNormals();
-    vpg->unrequireVertexLumpedMassMatrix();
-    vpg->unrequireCotanLaplacian();
     vpg->unrequireFaceAreas();
     vpg->unrequireVertexIndices();
-    vpg->unrequireVertexGaussianCurvatures();
     vpg->unrequireVertexMeanCurvatures();
     vpg->unrequireFaceIndices();
     vpg->unrequireEdgeLengths();
     vpg->unrequireVertexNormals();
     vpg->unrequireVertexDualAreas();
     vpg->unrequireCornerAngles();
-    vpg->unrequireCornerScaledAngles();
-    vpg->unrequireDECOperators();
     vpg->unrequireEdgeDihedralAngles();
     vpg->unrequireHalfedgeCotanWeights();
-    vpg->unrequireEdgeCotanWeights();
   }
 
   // ==========================================================
@@ -613,11 +734,21 @@ public:
   void pcg_test();
 
   /**
-   * @brief Initialize all constant values (on refVpg) needed for computation
+   * @brief Initialize all constant values (on refVpg) needed for computation.
+   * Random number generators are seeded with parameters.dpd.seed, or from
+   * std::random_device if it is negative
    *
    */
   void initConstants();
 
+  /**
+   * @brief Initialize all constant values (on refVpg) needed for computation
+   * with an explicit seed of the random number generators
+   *
+   * @param seed        seed of the random number generators
+   */
+  void initConstants(std::uint64_t seed);
+
   /**
    * @brief Mesh mutation
    */
@@ -632,6 +763,35 @@ public:
    */
   void updateConfigurations(bool isUpdateGeodesics = false);
 
+  /**
+   * @brief Recompute the required geometric quantities and the enclosed volume
+   * after vertex positions changed. The fused kernel is used when enabled,
+   * and vpg->refreshQuantities() on the first refresh after a change of
+   * topology
+   */
+  void refreshGeometry();
+
+  /**
+   * @brief Whether vertex positions and topology are unchanged since the last
+   * geometry refresh, in which case cached geometry is still valid
+   */
+  bool isGeometryRefreshed() const;
+
+  /**
+   * @brief Bitmask of the optional geometric quantities read by the active
+   * force and energy terms, including extraGeometricQuantities
+   */
+  unsigned activeGeometricQuantities() const;
+
+  /**
+   * @brief Require the optional geometric quantities in the bitmask and
+   * release the others, so that vpg->refreshQuantities() only recomputes what
+   * is read. Quantities newly required are computed on the spot
+   *
+   * @param quantities  bitmask of GeometricQuantity
+   */
+  void requireGeometricQuantities(unsigned quantities);
+
   // ==========================================================
   // ================   Variational vectors  ==================
   // ==========================================================
@@ -698,6 +858,15 @@ public:
   gc::Vector3 cornerAngleGradient(gcs::Corner c, gcs::Vertex v);
   gc::Vector3 dihedralAngleGradient(gcs::Halfedge he, gcs::Vertex v);
 
+  /**
+   * @brief Fill the cached halfedge variational vectors shared by the force
+   * kernels, for all halfedges or a single halfedge. Corner angle gradients
+   * are only evaluated if the deviatoric term is active
+   */
+  void updateHalfedgeVariationalVectors();
+  void updateHalfedgeVariationalVectors(gcs::Halfedge he,
+                                        bool isDeviatoric = true);
+
   // ==========================================================
   // ================        Pressure        ==================
   // ==========================================================
@@ -707,6 +876,17 @@ public:
   void computePhysicalForcing();
   void computePhysicalForcing(double timeStep);
 
+  /**
+   * @brief Zero the per-component force and chemical potential buffers
+   */
+  void zeroForceComponents();
+
+  /**
+   * @brief Compute all forcing with the per-component buffers and their normal
+   * projections regardless of forces.isFullDiagnostics, e.g. on save frames
+   */
+  void computeForceComponents();
+
   /**
    * @brief Compute chemical potential of the system
    */
@@ -717,6 +897,15 @@ public:
    */
   void computeSelfAvoidanceForce();
 
+  /**
+   * @brief Update the cached self-avoidance potential sum_j phi_j / (r_ij - d)
+   * and field sum_j phi_j / (r_ij - d)^2 * r_ij / |r_ij| of all vertices using
+   * the Barnes-Hut approximation, excluding the neighborhood layers. The tree
+   * is only rebuilt when the positions, protein density, exclusions or
+   * parameters changed, so energy and force share one evaluation
+   */
+  void updateSelfAvoidanceField();
+
   /**
    * @brief Compute mechanical forces
    */
@@ -724,6 +913,41 @@ public:
   void computeMechanicalForces(size_t i);
   void computeMechanicalForces(gcs::Vertex &v);
 
+  /**
+   * @brief Bitmask of the optional mechanical terms with nonzero modulus
+   */
+  unsigned activeMechanicalTerms() const;
+
+  /**
+   * @brief Assemble mechanical forces on all vertices or a vertex from the
+   * cached halfedge variational vectors, specialized on the bitmask of active
+   * MechanicalTerm
+   */
+  template <unsigned Terms> void assembleMechanicalForces();
+  template <unsigned Terms> void assembleMechanicalForces(size_t i);
+
+  /**
+   * @brief Greedy edge coloring such that edges of the same color share no
+   * vertex, used for the race free parallel scatter of the DPD forces. Rebuilt
+   * only after topology change
+   */
+  void updateEdgeColoring();
+
+  /**
+   * @brief Accumulate the mechanical force contribution of a halfedge to its
+   * tail vertex
+   */
+  template <unsigned Terms>
+  void accumulateHalfedgeMechanicalForces(
+      gcs::Halfedge he, MechanicalForceContribution &contribution);
+
+  /**
+   * @brief Combine, mask and store the accumulated mechanical forces of a
+   * vertex into the force buffers
+   */
+  void storeMechanicalForces(size_t i,
+                             const MechanicalForceContribution &contribution);
+
   /**
    * @brief Compute external force component of the system
    */
@@ -809,10 +1033,19 @@ public:
   /**
    * @brief Compute the L1 norm of the pressure
    */
-  double computeNorm(
-      Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> &force) const;
-  double computeNorm(
-      Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> &&force) const;
+  template <typename Derived>
+  double computeNorm(const Eigen::MatrixBase<Derived> &force) const {
+    // Eigen::Matrix<double, Eigen::Dynamic, 1> mask =
+    //     outlierMask(force).cast<double>();
+
+    // return rowwiseProduct(mask, force).cwiseAbs().sum() /
+    //        rowwiseProduct(mask, vpg->vertexDualAreas.raw()).sum();
+    // L1 Norm
+    // return force.lpNorm<1>();
+
+    // no temporary is formed for maps and expressions
+    return force.norm();
+  }
   /**
    * @brief Intermediate function to integrate the power
    */
@@ -860,6 +1093,25 @@ public:
   computeGradientNorm2Gradient(const gcs::Halfedge &he,
                                const gcs::VertexData<double> &quantities);
 
+  /**
+   * @brief Rebuild the self-avoidance exclusion table if topology or the
+   * number of excluded neighborhood layers has changed
+   */
+  void updateSelfAvoidanceExclusions();
+
+  /**
+   * @brief Rebuild the cell list and the self-avoidance pair list from current
+   * vertex positions
+   */
+  void updateSelfAvoidancePairs();
+
+  /**
+   * @brief Apply the function to all self-avoidance vertex pairs (i < j), using
+   * the pair list if cutoff is given and all pairs otherwise
+   */
+  void forEachSelfAvoidancePair(
+      const std::function<void(std::size_t, std::size_t)> &pairFunction);
+
   /**
    * @brief Find "the" vertex
    */
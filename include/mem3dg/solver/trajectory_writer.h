@@ -0,0 +1,148 @@
+// Membrane Dynamics in 3D using Discrete Differential Geometry (Mem3DG)
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Copyright (c) 2020:
+//     Laboratory for Computational Cellular Mechanobiology
+//     Cuncheng Zhu (cuzhu@eng.ucsd.edu)
+//     Christopher T. Lee (ctlee@ucsd.edu)
+//     Ravi Ramamoorthi (ravir@cs.ucsd.edu)
+//     Padmini Rangamani (prangamani@eng.ucsd.edu)
+//
+
+/**
+ * @file  trajectory_writer.h
+ * @brief Asynchronous netcdf trajectory output
+ *
+ */
+
+#pragma once
+
+#ifdef MEM3DG_WITH_NETCDF
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "mem3dg/macros.h"
+#include "mem3dg/solver/mutable_trajfile.h"
+#include "mem3dg/type_utilities.h"
+
+namespace mem3dg {
+namespace solver {
+
+/**
+ * @brief Background thread writing frames to a MutableTrajFile. The
+ * simulation copies a frame into a pooled buffer and continues while the
+ * frame is compressed and written, blocking only if the queue is full. Frames
+ * are written in order, and only the writer thread accesses the file while it
+ * is running
+ */
+class DLL_PUBLIC TrajectoryWriter {
+public:
+  /// snapshot of a trajectory frame
+  struct Frame {
+    double time = 0;
+    EigenVectorX3dr coords;
+    /// references the last written topology if empty
+    EigenVectorX3ur topology;
+    EigenVectorX3dr velocity;
+    EigenVectorX1d proteinDensity;
+    /// not written if empty
+    EigenVectorX3dr externalForce;
+  };
+
+  TrajectoryWriter() = default;
+  TrajectoryWriter(const TrajectoryWriter &) = delete;
+  TrajectoryWriter &operator=(const TrajectoryWriter &) = delete;
+  ~TrajectoryWriter();
+
+  /**
+   * @brief Start the writer thread
+   *
+   * @param file        trajectory file, not to be accessed until stop()
+   * @param capacity    maximum number of frames queued or being written
+   * @param syncPeriod  sync the file every syncPeriod frames, 0 to only sync
+   * on flush() and stop()
+   */
+  void start(MutableTrajFile &file, std::size_t capacity,
+             std::size_t syncPeriod);
+
+  /**
+   * @brief Whether the writer thread is running
+   */
+  bool isRunning() const { return worker.joinable(); }
+
+  /**
+   * @brief Get a free frame to fill, blocking while the queue is full. The
+   * buffers are recycled, so filling a frame of unchanged size does not
+   * allocate
+   *
+   * @return frame to be queued by push()
+   */
+  Frame &acquire();
+
+  /**
+   * @brief Queue the frame returned by the last acquire()
+   */
+  void push();
+
+  /**
+   * @brief Wait until all queued frames are written and sync the file
+   */
+  void flush();
+
+  /**
+   * @brief Write the queued frames, sync the file and join the writer thread
+   */
+  void stop();
+
+private:
+  /// loop of the writer thread
+  void run();
+  /// write a frame at the end of the file
+  void write(const Frame &frame);
+  /// rethrow, and clear, the error raised in the writer thread
+  void rethrow();
+
+  /// trajectory file
+  MutableTrajFile *file = nullptr;
+  /// maximum number of frames queued or being written
+  std::size_t capacity = 2;
+  /// number of frames between syncs, 0 to only sync on request
+  std::size_t syncPeriod = 1;
+  /// number of frames written
+  std::size_t nWritten = 0;
+
+  std::thread worker;
+  std::mutex mutex;
+  std::condition_variable condition;
+  /// frames to be written, in order
+  std::deque<std::unique_ptr<Frame>> queue;
+  /// free frames
+  std::vector<std::unique_ptr<Frame>> pool;
+  /// frame being filled by the simulation
+  std::unique_ptr<Frame> pending;
+  /// whether the writer thread is writing a frame taken off the queue
+  bool isWriting = false;
+  /// whether a sync is requested by flush()
+  bool isSyncRequested = false;
+  /// whether the writer thread is asked to exit
+  bool isStopping = false;
+  /// error raised in the writer thread
+  std::exception_ptr error;
+};
+
+} // namespace solver
+} // namespace mem3dg
+
+#endif
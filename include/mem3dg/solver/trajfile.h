@@ -37,6 +37,7 @@
 #include "mem3dg/macros.h"
 #include "mem3dg/meshops.h"
 #include "mem3dg/solver/trajfile_constants.h"
+#include "mem3dg/solver/trajfile_storage.h"
 #include "mem3dg/type_utilities.h"
 
 namespace mem3dg {
@@ -112,16 +113,25 @@ public:
     refsurfarea = fd->getVar(REFSURFAREA_VAR);
     mask_var = fd->getVar(MASK_VAR);
     H_H0_var = fd->getVar(H_H0_VAR);
+
+    storage.coordinates =
+        VariableStorage::fromVariable(coord_var, coord_var.getType());
+    storage.velocity =
+        VariableStorage::fromVariable(vel_var, vel_var.getType());
+    storage.proteinDensity =
+        VariableStorage::fromVariable(phi_var, phi_var.getType());
   }
 
   void createNewFile(const std::string &filename, gcs::SurfaceMesh &mesh,
                      gcs::VertexPositionGeometry &refVpg,
-                     const NcFile::FileMode fMode) {
+                     const NcFile::FileMode fMode,
+                     const TrajStorage &storage_ = TrajStorage()) {
     if (fd != nullptr) {
       mem3dg_runtime_error("Cannot open an already open ...");
     }
 
     writeable = true;
+    storage = storage_;
 
     fd = new NcFile(filename, fMode);
     // initialize data
@@ -162,9 +172,10 @@ public:
 
     issmooth_var = fd->addVar(ISSMOOTH_VAR, netCDF::ncByte, {frame_dim});
 
-    coord_var = fd->addVar(COORD_VAR, netCDF::ncDouble,
+    coord_var = fd->addVar(COORD_VAR, storage.coordinates.ncType(),
                            {frame_dim, nvertices_dim, spatial_dim});
     coord_var.putAtt(UNITS, LEN_UNITS);
+    storage.coordinates.putAttributes(coord_var);
 
     topo_frame_var = fd->addVar(TOPO_FRAME_VAR, netCDF::ncUint,
                                 {frame_dim, npolygons_dim, polygon_order_dim});
@@ -172,13 +183,15 @@ public:
     angle_var =
         fd->addVar(ANGLE_VAR, netCDF::ncDouble, {frame_dim, ncorners_dim});
 
-    vel_var = fd->addVar(VEL_VAR, netCDF::ncDouble,
+    vel_var = fd->addVar(VEL_VAR, storage.velocity.ncType(),
                          {frame_dim, nvertices_dim, spatial_dim});
     vel_var.putAtt(UNITS, LEN_UNITS + TIME_UNITS + "^(-1)");
+    storage.velocity.putAttributes(vel_var);
 
-    phi_var = fd->addVar(PHI_VAR, netCDF::ncDouble,
-                                {frame_dim, nvertices_dim});
+    phi_var = fd->addVar(PHI_VAR, storage.proteinDensity.ncType(),
+                         {frame_dim, nvertices_dim});
     phi_var.putAtt(UNITS, LEN_UNITS + "^(-2)");
+    storage.proteinDensity.putAttributes(phi_var);
 
     meancurve_var =
         fd->addVar(MEANCURVE_VAR, netCDF::ncDouble, {frame_dim, nvertices_dim});
@@ -288,6 +301,7 @@ public:
    * @param filename  Filename to save to
    * @param mesh      Mesh of interest
    * @param replace   Whether to replace an existing file or exit
+   * @param storage   Storage precision of the per-vertex variables
    *
    * @exception netCDF::exceptions::NcExist File already exists and
    * replace/overwrite flag is not specified.
@@ -296,11 +310,12 @@ public:
    */
   static TrajFile newFile(const std::string &filename, gcs::SurfaceMesh &mesh,
                           gcs::VertexPositionGeometry &refVpg,
-                          bool replace = false) {
+                          bool replace = false,
+                          const TrajStorage &storage = TrajStorage()) {
     if (replace)
-      return TrajFile(filename, mesh, refVpg, NcFile::replace);
+      return TrajFile(filename, mesh, refVpg, NcFile::replace, storage);
     else
-      return TrajFile(filename, mesh, refVpg, NcFile::newFile);
+      return TrajFile(filename, mesh, refVpg, NcFile::newFile, storage);
   };
 
   /**
@@ -579,17 +594,23 @@ private:
    * @param filename Path to file of interest
    * @param mesh     Mesh to store
    * @param fMode    Mode to create file with (replace, newFile)
+   * @param storage_ Storage precision of the per-vertex variables
    */
   TrajFile(const std::string &filename, gcs::SurfaceMesh &mesh,
-           gcs::VertexPositionGeometry &refVpg, const NcFile::FileMode fMode)
+           gcs::VertexPositionGeometry &refVpg, const NcFile::FileMode fMode,
+           const TrajStorage &storage_ = TrajStorage())
       : filename(filename), // fd(new NcFile(filename, fMode)),
         writeable(true) {
-    createNewFile(filename, mesh, refVpg, fMode);
+    createNewFile(filename, mesh, refVpg, fMode, storage_);
   }
 
   /// Bound NcFile
   NcFile *fd;
 
+  /// Storage precision of the per-vertex variables, external force is
+  /// ignored
+  TrajStorage storage;
+
   // Save dimensions
   nc::NcDim frame_dim;
   nc::NcDim npolygons_dim;
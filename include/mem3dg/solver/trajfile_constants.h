@@ -73,6 +73,8 @@ static const std::string COORD_VAR = "coordinates";
 static const std::string TOPO_VAR = "topology";
 /// Name of the mesh topology data
 static const std::string TOPO_FRAME_VAR = "topologyframe";
+/// Name of the frame whose topology each frame reuses
+static const std::string TOPO_REF_VAR = "topologyref";
 /// Name of the mesh corner angle data
 static const std::string ANGLE_VAR = "angle";
 /// Name of the refMesh coordinates data
@@ -144,10 +146,36 @@ static const std::string MASK_VAR = "mask";
 /// Name of the curvature difference data
 static const std::string H_H0_VAR = "curvaturediff";
 
+/// Name of the layout attribute of the trajectory group
+static const std::string LAYOUT_NAME = "layout";
+/// Layout storing per-vertex data in fixed shape chunked variables per epoch
+static const std::string CHUNKED_LAYOUT_VALUE = "chunked";
+/// Name prefix of the group of a topology epoch
+static const std::string EPOCH_GROUP_PREFIX = "epoch";
+/// Name of the epoch index data of the frames
+static const std::string EPOCH_VAR = "epoch";
+/// Name of frames within a topology epoch
+static const std::string EPOCH_FRAME_NAME = "epochframe";
+/// Name of the first frame attribute of a topology epoch
+static const std::string FIRST_FRAME_NAME = "firstframe";
+
+/// Name of the packing scale attribute of int16 data, following CF
+static const std::string SCALE_FACTOR_NAME = "scale_factor";
+/// Name of the packing offset attribute of int16 data, following CF
+static const std::string ADD_OFFSET_NAME = "add_offset";
+/// Smallest packed int16 value, -32767 is the default fill value
+static const std::int16_t INT16_PACKED_MIN = -32766;
+/// Largest packed int16 value
+static const std::int16_t INT16_PACKED_MAX = 32767;
+
 /// Name of uint array vlen type
 static const std::string UINT_ARR = "uint_array";
 /// Name of double array vlen type
 static const std::string DOUBLE_ARR = "double_array";
+/// Name of float array vlen type
+static const std::string FLOAT_ARR = "float_array";
+/// Name of int16 array vlen type
+static const std::string SHORT_ARR = "short_array";
 
 #endif
 } // namespace solver
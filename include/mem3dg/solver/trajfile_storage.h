@@ -0,0 +1,169 @@
+// Membrane Dynamics in 3D using Discrete Differential Geometry (Mem3DG)
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Copyright (c) 2020:
+//     Laboratory for Computational Cellular Mechanobiology
+//     Cuncheng Zhu (cuzhu@eng.ucsd.edu)
+//     Christopher T. Lee (ctlee@ucsd.edu)
+//     Ravi Ramamoorthi (ravir@cs.ucsd.edu)
+//     Padmini Rangamani (prangamani@eng.ucsd.edu)
+//
+
+/**
+ * @file  trajfile_storage.h
+ * @brief Storage precision of netcdf trajectory variables
+ *
+ */
+
+#pragma once
+
+#ifdef MEM3DG_WITH_NETCDF
+
+#include <cstdint>
+#include <netcdf>
+#include <string>
+
+#include <Eigen/Core>
+
+#include "mem3dg/macros.h"
+#include "mem3dg/solver/trajfile_constants.h"
+
+namespace mem3dg {
+namespace solver {
+
+namespace nc = ::netCDF;
+
+/// Storage type of a floating point trajectory variable
+enum class StoragePrecision { Double, Float, Int16 };
+
+/**
+ * @brief Storage of a per-vertex trajectory variable, chosen at file creation.
+ * Readers always return doubles. Int16 stores round((value - offset) / scale),
+ * saturated to the packed range, with scale and offset recorded in the CF
+ * scale_factor and add_offset attributes. CF aware readers such as
+ * netCDF4-python only unpack fixed shape variables, i.e. TrajFile and the
+ * chunked MutableTrajFile layout. They return the vlen variables of the
+ * default MutableTrajFile layout still packed as int16
+ */
+struct VariableStorage {
+  /// storage type
+  StoragePrecision precision = StoragePrecision::Double;
+  /// packing scale of Int16
+  double scale = 1;
+  /// packing offset of Int16
+  double offset = 0;
+
+  /**
+   * @brief Single precision storage
+   */
+  static VariableStorage single() {
+    VariableStorage storage;
+    storage.precision = StoragePrecision::Float;
+    return storage;
+  }
+
+  /**
+   * @brief Int16 storage resolving [lower, upper] in 65533 steps, e.g.
+   * quantized(0, 1) for protein density
+   *
+   * @param lower   smallest value to be represented
+   * @param upper   largest value to be represented
+   */
+  static VariableStorage quantized(double lower, double upper) {
+    if (!(upper > lower))
+      mem3dg_runtime_error("Quantization range has to be nonempty!");
+    VariableStorage storage;
+    storage.precision = StoragePrecision::Int16;
+    storage.scale =
+        (upper - lower) / (double(INT16_PACKED_MAX) - INT16_PACKED_MIN);
+    storage.offset = lower - INT16_PACKED_MIN * storage.scale;
+    return storage;
+  }
+
+  /**
+   * @brief Get the storage of an existing variable
+   *
+   * @param var     variable
+   * @param type    stored element type, the base type of vlen variables
+   */
+  static VariableStorage fromVariable(const nc::NcVar &var,
+                                      const nc::NcType &type) {
+    VariableStorage storage;
+    if (type.getId() == NC_FLOAT) {
+      storage.precision = StoragePrecision::Float;
+    } else if (type.getId() == NC_SHORT) {
+      storage.precision = StoragePrecision::Int16;
+      var.getAtt(SCALE_FACTOR_NAME).getValues(&storage.scale);
+      var.getAtt(ADD_OFFSET_NAME).getValues(&storage.offset);
+    }
+    return storage;
+  }
+
+  /**
+   * @brief Stored element type
+   */
+  nc::NcType ncType() const {
+    switch (precision) {
+    case StoragePrecision::Float:
+      return nc::ncFloat;
+    case StoragePrecision::Int16:
+      return nc::ncShort;
+    default:
+      return nc::ncDouble;
+    }
+  }
+
+  /**
+   * @brief Record the packing attributes of Int16 on the variable
+   */
+  void putAttributes(nc::NcVar &var) const {
+    if (precision == StoragePrecision::Int16) {
+      var.putAtt(SCALE_FACTOR_NAME, nc::ncDouble, scale);
+      var.putAtt(ADD_OFFSET_NAME, nc::ncDouble, offset);
+    }
+  }
+
+  /**
+   * @brief Pack data to Int16
+   *
+   * @tparam Packed   int16 matrix type of the result
+   */
+  template <typename Packed, typename Derived>
+  Packed pack(const Eigen::MatrixBase<Derived> &data) const {
+    return ((data.array() - offset) / scale)
+        .round()
+        .max(double(INT16_PACKED_MIN))
+        .min(double(INT16_PACKED_MAX))
+        .template cast<std::int16_t>()
+        .matrix();
+  }
+
+  /**
+   * @brief Unpack data read as doubles in place, no-op unless Int16
+   */
+  template <typename Derived>
+  void unpack(Eigen::MatrixBase<Derived> &data) const {
+    if (precision == StoragePrecision::Int16)
+      data.array() = data.array() * scale + offset;
+  }
+};
+
+/// Storage of the per-vertex fields of a trajectory file
+struct TrajStorage {
+  /// vertex coordinates
+  VariableStorage coordinates;
+  /// vertex velocities
+  VariableStorage velocity;
+  /// protein density
+  VariableStorage proteinDensity;
+  /// external force, only stored by MutableTrajFile
+  VariableStorage externalForce;
+};
+
+} // namespace solver
+} // namespace mem3dg
+
+#endif
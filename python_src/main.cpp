@@ -107,6 +107,37 @@ PYBIND11_MODULE(_core, pymem3dg) {
                                R"delim(
           name of the trajectory file 
       )delim");
+  velocityverlet.def_readwrite("isChunkedTrajectory",
+                               &VelocityVerlet::isChunkedTrajectory,
+                               R"delim(
+          whether store per-vertex data in chunked variables per topology epoch
+      )delim");
+#ifdef MEM3DG_WITH_NETCDF
+  velocityverlet.def_readwrite("trajectoryStorage",
+                               &VelocityVerlet::trajectoryStorage,
+                               R"delim(
+          storage precision of the per-vertex trajectory data
+      )delim");
+#endif
+  velocityverlet.def_readwrite("isAsyncTrajectoryWriter",
+                               &VelocityVerlet::isAsyncTrajectoryWriter,
+                               R"delim(
+          whether write the trajectory in a background thread
+      )delim");
+  velocityverlet.def_readwrite("trajectoryQueueCapacity",
+                               &VelocityVerlet::trajectoryQueueCapacity,
+                               R"delim(
+          maximum number of frames queued for the background writer
+      )delim");
+  velocityverlet.def_readwrite("syncPeriod", &VelocityVerlet::syncPeriod,
+                               R"delim(
+          number of frames between syncs of the file, 0 to only sync on exit
+      )delim");
+  velocityverlet.def_readwrite("isSyncOnInterrupt",
+                               &VelocityVerlet::isSyncOnInterrupt,
+                               R"delim(
+          whether finish and save the last frame on SIGINT
+      )delim");
   velocityverlet.def_readwrite("isAdaptiveStep",
                                &VelocityVerlet::isAdaptiveStep,
                                R"delim(
@@ -125,6 +156,17 @@ PYBIND11_MODULE(_core, pymem3dg) {
                                R"delim(
            verbosity level of integrator
       )delim");
+  velocityverlet.def_readwrite("isImplicitProteinDiffusion",
+                               &VelocityVerlet::isImplicitProteinDiffusion,
+                               R"delim(
+          whether integrate the protein diffusion by backward Euler
+      )delim");
+  velocityverlet.def_readwrite(
+      "diffusionRefactorizationTolerance",
+      &VelocityVerlet::diffusionRefactorizationTolerance,
+      R"delim(
+          relative drift of the Laplacian that triggers a refactorization
+      )delim");
 
   velocityverlet.def("integrate", &VelocityVerlet::integrate,
                      R"delim(
@@ -193,6 +235,34 @@ PYBIND11_MODULE(_core, pymem3dg) {
                       R"delim(
           name of the trajectory file 
       )delim");
+  euler.def_readwrite("isChunkedTrajectory", &Euler::isChunkedTrajectory,
+                      R"delim(
+          whether store per-vertex data in chunked variables per topology epoch
+      )delim");
+#ifdef MEM3DG_WITH_NETCDF
+  euler.def_readwrite("trajectoryStorage", &Euler::trajectoryStorage,
+                      R"delim(
+          storage precision of the per-vertex trajectory data
+      )delim");
+#endif
+  euler.def_readwrite("isAsyncTrajectoryWriter",
+                      &Euler::isAsyncTrajectoryWriter,
+                      R"delim(
+          whether write the trajectory in a background thread
+      )delim");
+  euler.def_readwrite("trajectoryQueueCapacity",
+                      &Euler::trajectoryQueueCapacity,
+                      R"delim(
+          maximum number of frames queued for the background writer
+      )delim");
+  euler.def_readwrite("syncPeriod", &Euler::syncPeriod,
+                      R"delim(
+          number of frames between syncs of the file, 0 to only sync on exit
+      )delim");
+  euler.def_readwrite("isSyncOnInterrupt", &Euler::isSyncOnInterrupt,
+                      R"delim(
+          whether finish and save the last frame on SIGINT
+      )delim");
   euler.def_readwrite("isAdaptiveStep", &Euler::isAdaptiveStep,
                       R"delim(
           option to scale time step according to mesh size
@@ -221,6 +291,43 @@ PYBIND11_MODULE(_core, pymem3dg) {
                       R"delim(
           Wolfe condition parameter
       )delim");
+  euler.def_readwrite("isInterpolatingLineSearch",
+                      &Euler::isInterpolatingLineSearch,
+                      R"delim(
+          whether choose trial steps by quadratic/cubic interpolation
+      )delim");
+  euler.def_readwrite("isStrongWolfe", &Euler::isStrongWolfe,
+                      R"delim(
+          whether enforce strong Wolfe conditions in interpolating line search
+      )delim");
+  euler.def_readwrite("c2", &Euler::c2,
+                      R"delim(
+          Wolfe curvature condition parameter
+      )delim");
+  euler.def_readwrite("isSobolevPreconditioned",
+                      &Euler::isSobolevPreconditioned,
+                      R"delim(
+          whether precondition the shape force with the H^2 Sobolev metric
+      )delim");
+  euler.def_readwrite("sobolevScale", &Euler::sobolevScale,
+                      R"delim(
+          squared Sobolev smoothing length, in squared mean edge length
+      )delim");
+  euler.def_readwrite("sobolevRefactorizationPeriod",
+                      &Euler::sobolevRefactorizationPeriod,
+                      R"delim(
+          number of steps between refactorizations of the Sobolev metric
+      )delim");
+  euler.def_readwrite("isImplicitProteinDiffusion",
+                      &Euler::isImplicitProteinDiffusion,
+                      R"delim(
+          whether integrate the protein diffusion by backward Euler
+      )delim");
+  euler.def_readwrite("diffusionRefactorizationTolerance",
+                      &Euler::diffusionRefactorizationTolerance,
+                      R"delim(
+          relative drift of the Laplacian that triggers a refactorization
+      )delim");
 
   /**
    * @brief methods
@@ -246,6 +353,11 @@ PYBIND11_MODULE(_core, pymem3dg) {
             R"delim(
           step for n iterations
       )delim");
+  euler.def("getAverageLineSearchEvaluations",
+            &Euler::getAverageLineSearchEvaluations,
+            R"delim(
+          get the average number of energy evaluations per line search
+      )delim");
 
   // ==========================================================
   // =============     Conjugate Gradient       ===============
@@ -299,6 +411,37 @@ PYBIND11_MODULE(_core, pymem3dg) {
                                   R"delim(
           name of the trajectory file 
       )delim");
+  conjugategradient.def_readwrite("isChunkedTrajectory",
+                                  &ConjugateGradient::isChunkedTrajectory,
+                                  R"delim(
+          whether store per-vertex data in chunked variables per topology epoch
+      )delim");
+#ifdef MEM3DG_WITH_NETCDF
+  conjugategradient.def_readwrite("trajectoryStorage",
+                                  &ConjugateGradient::trajectoryStorage,
+                                  R"delim(
+          storage precision of the per-vertex trajectory data
+      )delim");
+#endif
+  conjugategradient.def_readwrite("isAsyncTrajectoryWriter",
+                                  &ConjugateGradient::isAsyncTrajectoryWriter,
+                                  R"delim(
+          whether write the trajectory in a background thread
+      )delim");
+  conjugategradient.def_readwrite("trajectoryQueueCapacity",
+                                  &ConjugateGradient::trajectoryQueueCapacity,
+                                  R"delim(
+          maximum number of frames queued for the background writer
+      )delim");
+  conjugategradient.def_readwrite("syncPeriod", &ConjugateGradient::syncPeriod,
+                                  R"delim(
+          number of frames between syncs of the file, 0 to only sync on exit
+      )delim");
+  conjugategradient.def_readwrite("isSyncOnInterrupt",
+                                  &ConjugateGradient::isSyncOnInterrupt,
+                                  R"delim(
+          whether finish and save the last frame on SIGINT
+      )delim");
   conjugategradient.def_readwrite("isAdaptiveStep",
                                   &ConjugateGradient::isAdaptiveStep,
                                   R"delim(
@@ -331,6 +474,36 @@ PYBIND11_MODULE(_core, pymem3dg) {
                                   R"delim(
           Wolfe condition parameter
       )delim");
+  conjugategradient.def_readwrite("isInterpolatingLineSearch",
+                                  &ConjugateGradient::isInterpolatingLineSearch,
+                                  R"delim(
+          whether choose trial steps by quadratic/cubic interpolation
+      )delim");
+  conjugategradient.def_readwrite("isStrongWolfe",
+                                  &ConjugateGradient::isStrongWolfe,
+                                  R"delim(
+          whether enforce strong Wolfe conditions in interpolating line search
+      )delim");
+  conjugategradient.def_readwrite("c2", &ConjugateGradient::c2,
+                                  R"delim(
+          Wolfe curvature condition parameter
+      )delim");
+  conjugategradient.def_readwrite("isSobolevPreconditioned",
+                                  &ConjugateGradient::isSobolevPreconditioned,
+                                  R"delim(
+          whether precondition the shape force with the H^2 Sobolev metric
+      )delim");
+  conjugategradient.def_readwrite("sobolevScale",
+                                  &ConjugateGradient::sobolevScale,
+                                  R"delim(
+          squared Sobolev smoothing length, in squared mean edge length
+      )delim");
+  conjugategradient.def_readwrite(
+      "sobolevRefactorizationPeriod",
+      &ConjugateGradient::sobolevRefactorizationPeriod,
+      R"delim(
+          number of steps between refactorizations of the Sobolev metric
+      )delim");
   conjugategradient.def_readwrite("restartPeriod",
                                   &ConjugateGradient::restartPeriod,
                                   R"delim(
@@ -371,27 +544,142 @@ PYBIND11_MODULE(_core, pymem3dg) {
                         R"delim(
           step for n iterations
       )delim");
+  conjugategradient.def("getAverageLineSearchEvaluations",
+                        &ConjugateGradient::getAverageLineSearchEvaluations,
+                        R"delim(
+          get the average number of energy evaluations per line search
+      )delim");
 
   // ==========================================================
   // =============            BFGS              ===============
   // ==========================================================
   py::class_<BFGS> bfgs(pymem3dg, "BFGS",
                         R"delim(
-        conjugate Gradient propagator
+        limited-memory BFGS propagator
     )delim");
 
-  bfgs.def(
-      py::init<System &, double, double, double, double, std::string, bool,
-               std::string, std::size_t, bool, double, double, double, bool>(),
-      py::arg("f"), py::arg("dt"), py::arg("total_time"), py::arg("tSave"),
-      py::arg("tolerance"), py::arg("outputDir"),
-      py::arg("isAdaptiveStep") = true, py::arg("trajFileName") = "traj.nc",
-      py::arg("verbosity") = 3, py::arg("isBacktrack") = true,
-      py::arg("rho") = 0.99, py::arg("c1") = 0.0001, py::arg("ctol") = 0.001,
-      py::arg("isAugmentedLagrangian") = false,
-      R"delim(
+  bfgs.def(py::init<System &, double, double, double, double, std::string>(),
+           py::arg("system"), py::arg("characteristicTimeStep"),
+           py::arg("totalTime"), py::arg("savePeriod"), py::arg("tolerance"),
+           py::arg("outputDirectory"),
+           R"delim(
         BFGS optimizer constructor
       )delim");
+
+  /**
+   * @brief attributes, integration options
+   */
+  bfgs.def_readonly("characteristicTimeStep", &BFGS::characteristicTimeStep,
+                    R"delim(
+          characteristic time step
+      )delim");
+  bfgs.def_readonly("totalTime", &BFGS::totalTime,
+                    R"delim(
+          time limit
+      )delim");
+  bfgs.def_readonly("savePeriod", &BFGS::savePeriod,
+                    R"delim(
+         period of saving output data
+      )delim");
+  bfgs.def_readonly("tolerance", &BFGS::tolerance,
+                    R"delim(
+          tolerance for termination
+      )delim");
+  bfgs.def_readwrite("updateGeodesicsPeriod", &BFGS::updateGeodesicsPeriod,
+                     R"delim(
+          period of update geodesics
+      )delim");
+  bfgs.def_readwrite("processMeshPeriod", &BFGS::processMeshPeriod,
+                     R"delim(
+          period of processing mesh
+      )delim");
+  bfgs.def_readwrite("trajFileName", &BFGS::trajFileName,
+                     R"delim(
+          name of the trajectory file 
+      )delim");
+  bfgs.def_readwrite("isChunkedTrajectory", &BFGS::isChunkedTrajectory,
+                     R"delim(
+          whether store per-vertex data in chunked variables per topology epoch
+      )delim");
+#ifdef MEM3DG_WITH_NETCDF
+  bfgs.def_readwrite("trajectoryStorage", &BFGS::trajectoryStorage,
+                     R"delim(
+          storage precision of the per-vertex trajectory data
+      )delim");
+#endif
+  bfgs.def_readwrite("isAsyncTrajectoryWriter", &BFGS::isAsyncTrajectoryWriter,
+                     R"delim(
+          whether write the trajectory in a background thread
+      )delim");
+  bfgs.def_readwrite("trajectoryQueueCapacity", &BFGS::trajectoryQueueCapacity,
+                     R"delim(
+          maximum number of frames queued for the background writer
+      )delim");
+  bfgs.def_readwrite("syncPeriod", &BFGS::syncPeriod,
+                     R"delim(
+          number of frames between syncs of the file, 0 to only sync on exit
+      )delim");
+  bfgs.def_readwrite("isSyncOnInterrupt", &BFGS::isSyncOnInterrupt,
+                     R"delim(
+          whether finish and save the last frame on SIGINT
+      )delim");
+  bfgs.def_readwrite("isAdaptiveStep", &BFGS::isAdaptiveStep,
+                     R"delim(
+          option to scale time step according to mesh size
+      )delim");
+  bfgs.def_readwrite("outputDirectory", &BFGS::outputDirectory,
+                     R"delim(
+          output directory
+      )delim");
+  bfgs.def_readwrite("verbosity", &BFGS::verbosity,
+                     R"delim(
+           verbosity level of integrator
+      )delim");
+  bfgs.def_readwrite("isJustGeometryPly", &BFGS::isJustGeometryPly,
+                     R"delim(
+           save .ply with just geometry
+      )delim");
+  bfgs.def_readwrite("historyLength", &BFGS::historyLength,
+                     R"delim(
+          number of (s, y) correction pairs kept in the limited memory
+      )delim");
+  bfgs.def_readwrite("isBacktrack", &BFGS::isBacktrack,
+                     R"delim(
+         whether do backtracking line search
+      )delim");
+  bfgs.def_readwrite("rho", &BFGS::rho,
+                     R"delim(
+          backtracking coefficient
+      )delim");
+  bfgs.def_readwrite("c1", &BFGS::c1,
+                     R"delim(
+          Wolfe condition parameter
+      )delim");
+  bfgs.def_readwrite("isInterpolatingLineSearch",
+                     &BFGS::isInterpolatingLineSearch,
+                     R"delim(
+          whether choose trial steps by quadratic/cubic interpolation
+      )delim");
+  bfgs.def_readwrite("isStrongWolfe", &BFGS::isStrongWolfe,
+                     R"delim(
+          whether enforce strong Wolfe conditions in interpolating line search
+      )delim");
+  bfgs.def_readwrite("c2", &BFGS::c2,
+                     R"delim(
+          Wolfe curvature condition parameter
+      )delim");
+  bfgs.def_readwrite("constraintTolerance", &BFGS::constraintTolerance,
+                     R"delim(
+            tolerance for constraints
+      )delim");
+  bfgs.def_readwrite("isAugmentedLagrangian", &BFGS::isAugmentedLagrangian,
+                     R"delim(
+            whether use augmented lagrangian method 
+      )delim");
+
+  /**
+   * @brief methods
+   */
   bfgs.def("integrate", &BFGS::integrate,
            R"delim(
           integrate 
@@ -412,6 +700,161 @@ PYBIND11_MODULE(_core, pymem3dg) {
            R"delim(
           step for n iterations
       )delim");
+  bfgs.def("getAverageLineSearchEvaluations",
+           &BFGS::getAverageLineSearchEvaluations,
+           R"delim(
+          get the average number of energy evaluations per line search
+      )delim");
+  bfgs.def("resetHistory", &BFGS::resetHistory,
+           R"delim(
+          discard the stored (s, y) pairs and restart from steepest descent
+      )delim");
+
+  // ==========================================================
+  // =============            FIRE              ===============
+  // ==========================================================
+  py::class_<FIRE> fire(pymem3dg, "FIRE",
+                        R"delim(
+        Fast Inertial Relaxation Engine (FIRE) minimizer
+    )delim");
+
+  fire.def(py::init<System &, double, double, double, double, std::string>(),
+           py::arg("system"), py::arg("characteristicTimeStep"),
+           py::arg("totalTime"), py::arg("savePeriod"), py::arg("tolerance"),
+           py::arg("outputDirectory"),
+           R"delim(
+        FIRE optimizer constructor
+      )delim");
+
+  /**
+   * @brief attributes, integration options
+   */
+  fire.def_readonly("characteristicTimeStep", &FIRE::characteristicTimeStep,
+                    R"delim(
+          characteristic time step
+      )delim");
+  fire.def_readonly("totalTime", &FIRE::totalTime,
+                    R"delim(
+          time limit
+      )delim");
+  fire.def_readonly("savePeriod", &FIRE::savePeriod,
+                    R"delim(
+         period of saving output data
+      )delim");
+  fire.def_readonly("tolerance", &FIRE::tolerance,
+                    R"delim(
+          tolerance for termination
+      )delim");
+  fire.def_readwrite("updateGeodesicsPeriod", &FIRE::updateGeodesicsPeriod,
+                     R"delim(
+          period of update geodesics
+      )delim");
+  fire.def_readwrite("processMeshPeriod", &FIRE::processMeshPeriod,
+                     R"delim(
+          period of processing mesh
+      )delim");
+  fire.def_readwrite("trajFileName", &FIRE::trajFileName,
+                     R"delim(
+          name of the trajectory file 
+      )delim");
+  fire.def_readwrite("isChunkedTrajectory", &FIRE::isChunkedTrajectory,
+                     R"delim(
+          whether store per-vertex data in chunked variables per topology epoch
+      )delim");
+#ifdef MEM3DG_WITH_NETCDF
+  fire.def_readwrite("trajectoryStorage", &FIRE::trajectoryStorage,
+                     R"delim(
+          storage precision of the per-vertex trajectory data
+      )delim");
+#endif
+  fire.def_readwrite("isAsyncTrajectoryWriter", &FIRE::isAsyncTrajectoryWriter,
+                     R"delim(
+          whether write the trajectory in a background thread
+      )delim");
+  fire.def_readwrite("trajectoryQueueCapacity", &FIRE::trajectoryQueueCapacity,
+                     R"delim(
+          maximum number of frames queued for the background writer
+      )delim");
+  fire.def_readwrite("syncPeriod", &FIRE::syncPeriod,
+                     R"delim(
+          number of frames between syncs of the file, 0 to only sync on exit
+      )delim");
+  fire.def_readwrite("isSyncOnInterrupt", &FIRE::isSyncOnInterrupt,
+                     R"delim(
+          whether finish and save the last frame on SIGINT
+      )delim");
+  fire.def_readwrite("isAdaptiveStep", &FIRE::isAdaptiveStep,
+                     R"delim(
+          option to scale time step according to mesh size
+      )delim");
+  fire.def_readwrite("outputDirectory", &FIRE::outputDirectory,
+                     R"delim(
+          output directory
+      )delim");
+  fire.def_readwrite("verbosity", &FIRE::verbosity,
+                     R"delim(
+           verbosity level of integrator
+      )delim");
+  fire.def_readwrite("isJustGeometryPly", &FIRE::isJustGeometryPly,
+                     R"delim(
+           save .ply with just geometry
+      )delim");
+  fire.def_readwrite("delayStep", &FIRE::delayStep,
+                     R"delim(
+          number of downhill steps before accelerating
+      )delim");
+  fire.def_readwrite("timeStepIncrease", &FIRE::timeStepIncrease,
+                     R"delim(
+          factor to grow the time step when accelerating
+      )delim");
+  fire.def_readwrite("timeStepDecrease", &FIRE::timeStepDecrease,
+                     R"delim(
+          factor to shrink the time step on uphill motion
+      )delim");
+  fire.def_readwrite("initialMixing", &FIRE::initialMixing,
+                     R"delim(
+          mixing parameter at the start and after uphill motion
+      )delim");
+  fire.def_readwrite("mixingDecrease", &FIRE::mixingDecrease,
+                     R"delim(
+          factor to shrink the mixing when accelerating
+      )delim");
+  fire.def_readwrite("maxTimeStepFactor", &FIRE::maxTimeStepFactor,
+                     R"delim(
+          maximum time step in characteristic time steps
+      )delim");
+  fire.def_readwrite("minTimeStepFactor", &FIRE::minTimeStepFactor,
+                     R"delim(
+          minimum time step in characteristic time steps
+      )delim");
+
+  /**
+   * @brief methods
+   */
+  fire.def("integrate", &FIRE::integrate,
+           R"delim(
+          integrate 
+      )delim");
+  fire.def("status", &FIRE::status,
+           R"delim(
+          status computation and thresholding
+      )delim");
+  fire.def("march", &FIRE::march,
+           R"delim(
+          stepping forward 
+      )delim");
+  fire.def("saveData", &FIRE::saveData,
+           R"delim(
+          save data to output directory
+      )delim");
+  fire.def("step", &FIRE::step, py::arg("n"),
+           R"delim(
+          step for n iterations
+      )delim");
+  fire.def("resetDynamics", &FIRE::resetDynamics,
+           R"delim(
+          stop the inertial motion and restore the initial time step and mixing
+      )delim");
 
 #pragma endregion integrators
 
@@ -435,6 +878,10 @@ PYBIND11_MODULE(_core, pymem3dg) {
       R"delim(
           get the osmotic pressure
       )delim");
+  forces.def_readwrite("isFullDiagnostics", &Forces::isFullDiagnostics,
+                       R"delim(
+          whether to keep the per-component forces during stepping
+      )delim");
 
   /**
    * @brief Mechanical force
@@ -886,19 +1333,41 @@ PYBIND11_MODULE(_core, pymem3dg) {
                        R"delim(
           get the surface area of the mesh
       )delim");
+  system.def_readwrite("isFusedGeometry", &System::isFusedGeometry,
+                       R"delim(
+          get whether to refresh geometry with the fused kernel
+      )delim");
+  system.def_readwrite("extraGeometricQuantities",
+                       &System::extraGeometricQuantities,
+                       R"delim(
+          get bitmask of geometric quantities refreshed regardless of the
+          active terms: 1 Gaussian curvature, 2 cotan Laplacian, 4 lumped mass
+          matrix, 8 DEC operators
+      )delim");
   system.def_readwrite("volume", &System::volume,
                        R"delim(
           get the enclosed volume of the mesh
       )delim");
   system.def(
       "getLumpedMassMatrix",
-      [](System &s) { return s.vpg->vertexLumpedMassMatrix; },
+      [](System &s) {
+        s.vpg->requireVertexLumpedMassMatrix();
+        Eigen::SparseMatrix<double> M = s.vpg->vertexLumpedMassMatrix;
+        s.vpg->unrequireVertexLumpedMassMatrix();
+        return M;
+      },
       py::return_value_policy::copy,
       R"delim(
           get the lumped mass matrix of the mesh
       )delim");
   system.def(
-      "getCotanLaplacian", [](System &s) { return s.vpg->cotanLaplacian; },
+      "getCotanLaplacian",
+      [](System &s) {
+        s.vpg->requireCotanLaplacian();
+        Eigen::SparseMatrix<double> L = s.vpg->cotanLaplacian;
+        s.vpg->unrequireCotanLaplacian();
+        return L;
+      },
       py::return_value_policy::copy,
       R"delim(
           get the Cotan Laplacian matrix of the mesh
@@ -927,13 +1396,25 @@ PYBIND11_MODULE(_core, pymem3dg) {
           get the face vertex matrix
       )delim");
   system.def(
-      "getVertexAdjacencyMatrix", [](System &s) { return s.vpg->d0; },
+      "getVertexAdjacencyMatrix",
+      [](System &s) {
+        s.vpg->requireDECOperators();
+        Eigen::SparseMatrix<double> d0 = s.vpg->d0;
+        s.vpg->unrequireDECOperators();
+        return d0;
+      },
       py::return_value_policy::copy,
       R"delim(
           get the signed E-V vertex adjacency matrix, equivalent of d0 operator
       )delim");
   system.def(
-      "getEdgeAdjacencyMatrix", [](System &s) { return s.vpg->d1; },
+      "getEdgeAdjacencyMatrix",
+      [](System &s) {
+        s.vpg->requireDECOperators();
+        Eigen::SparseMatrix<double> d1 = s.vpg->d1;
+        s.vpg->unrequireDECOperators();
+        return d1;
+      },
       py::return_value_policy::copy,
       R"delim(
           get the signed F-E edge adjacency matrix, equivalent of d1 operator
@@ -959,7 +1440,9 @@ PYBIND11_MODULE(_core, pymem3dg) {
       "getGaussianCurvature",
       [](System &s) {
         s.vpg->requireVertexGaussianCurvatures();
-        return s.vpg->vertexGaussianCurvatures.raw();
+        EigenVectorX1d K = s.vpg->vertexGaussianCurvatures.raw();
+        s.vpg->unrequireVertexGaussianCurvatures();
+        return K;
       },
       py::return_value_policy::copy,
       R"delim(
@@ -1047,6 +1530,10 @@ PYBIND11_MODULE(_core, pymem3dg) {
       R"delim(
             compute all the forces
         )delim");
+  system.def("computeForceComponents", &System::computeForceComponents,
+             R"delim(
+            compute all the forces including the per-component forces
+        )delim");
   //   system.def("computeBendingForce", &System::computeBendingForce,
   //              py::return_value_policy::copy,
   //              R"delim(
@@ -1306,6 +1793,10 @@ PYBIND11_MODULE(_core, pymem3dg) {
                     R"delim(
           get Dissipation coefficient 
       )delim");
+  dpd.def_readwrite("seed", &Parameters::DPD::seed,
+                    R"delim(
+          get seed of the random noise, negative to seed from random device
+      )delim");
 
   py::class_<Parameters::Dirichlet> dirichlet(pymem3dg, "Dirichlet",
                                               R"delim(
@@ -1336,6 +1827,16 @@ PYBIND11_MODULE(_core, pymem3dg) {
                               R"delim(
           get the period factor of self-avoidance computation
       )delim");
+  selfAvoidance.def_readwrite("cutoff", &Parameters::SelfAvoidance::cutoff,
+                              R"delim(
+          get the cutoff distance of neighbor search, 0 to use all pairs
+      )delim");
+  selfAvoidance.def_readwrite("theta", &Parameters::SelfAvoidance::theta,
+                              R"delim(
+          get the Barnes-Hut opening angle, 0 to compute exactly. The projected
+          collision time is then only estimated among pairs within the cutoff;
+          without a cutoff the force is updated every step
+      )delim");
 
   py::class_<Parameters::Point> point(pymem3dg, "Point",
                                       R"delim(
@@ -1563,6 +2064,142 @@ PYBIND11_MODULE(_core, pymem3dg) {
                py::arg("fileName"), py::arg("options"),
                py::arg("transparency") = 1, py::arg("fov") = 50,
                py::arg("edgeWidth") = 1);
+
+  /**
+   * @brief trajectory storage precision
+   */
+  py::enum_<StoragePrecision>(pymem3dg, "StoragePrecision", R"delim(
+        Storage type of a floating point trajectory variable
+    )delim")
+      .value("Double", StoragePrecision::Double)
+      .value("Float", StoragePrecision::Float)
+      .value("Int16", StoragePrecision::Int16);
+
+  py::class_<VariableStorage> variablestorage(pymem3dg, "VariableStorage",
+                                              R"delim(
+        Storage of a per-vertex trajectory variable, read back as double
+    )delim");
+  variablestorage.def(py::init<>());
+  variablestorage.def_readwrite("precision", &VariableStorage::precision,
+                                R"delim(
+          storage type
+      )delim");
+  variablestorage.def_readwrite("scale", &VariableStorage::scale,
+                                R"delim(
+          packing scale of Int16
+      )delim");
+  variablestorage.def_readwrite("offset", &VariableStorage::offset,
+                                R"delim(
+          packing offset of Int16
+      )delim");
+  variablestorage.def_static("single", &VariableStorage::single,
+                             R"delim(
+          single precision storage
+      )delim");
+  variablestorage.def_static("quantized", &VariableStorage::quantized,
+                             py::arg("lower"), py::arg("upper"),
+                             R"delim(
+          int16 storage resolving [lower, upper] in 65533 steps
+      )delim");
+
+  py::class_<TrajStorage> trajstorage(pymem3dg, "TrajStorage",
+                                      R"delim(
+        Storage of the per-vertex fields of a trajectory file
+    )delim");
+  trajstorage.def(py::init<>());
+  trajstorage.def_readwrite("coordinates", &TrajStorage::coordinates,
+                            R"delim(
+          storage of vertex coordinates
+      )delim");
+  trajstorage.def_readwrite("velocity", &TrajStorage::velocity,
+                            R"delim(
+          storage of vertex velocities
+      )delim");
+  trajstorage.def_readwrite("proteinDensity", &TrajStorage::proteinDensity,
+                            R"delim(
+          storage of protein density
+      )delim");
+  trajstorage.def_readwrite("externalForce", &TrajStorage::externalForce,
+                            R"delim(
+          storage of external force
+      )delim");
+
+  /**
+   * @brief trajectory reader
+   */
+  py::class_<MutableTrajFile> mutabletrajfile(pymem3dg, "MutableTrajFile",
+                                              R"delim(
+        Read only access to frames of a netcdf trajectory file
+    )delim");
+  mutabletrajfile.def(py::init([](const std::string &fileName) {
+                        auto fd = std::make_unique<MutableTrajFile>();
+                        fd->open(fileName, MutableTrajFile::NcFile::read);
+                        return fd;
+                      }),
+                      py::arg("fileName"),
+                      R"delim(
+        open a trajectory file read only
+      )delim");
+  mutabletrajfile.def("nFrames", &MutableTrajFile::nFrames,
+                      R"delim(
+        get the number of frames
+      )delim");
+  mutabletrajfile.def("getTime", &MutableTrajFile::getTime, py::arg("frame"),
+                      R"delim(
+        get the time of a frame
+      )delim");
+  mutabletrajfile.def("getTopologyFrame", &MutableTrajFile::getTopologyFrame,
+                      py::arg("frame"),
+                      R"delim(
+        get the frame storing the topology of a frame, readers only need to
+        resize their buffers when it changes
+      )delim");
+  mutabletrajfile.def("getNVertices", &MutableTrajFile::getNVertices,
+                      py::arg("frame"),
+                      R"delim(
+        get the number of vertices of a frame
+      )delim");
+  mutabletrajfile.def("getTopology", &MutableTrajFile::getTopology,
+                      py::arg("frame"),
+                      R"delim(
+        get the topology matrix of a frame
+      )delim");
+  mutabletrajfile.def(
+      "getCoords",
+      [](MutableTrajFile &fd, std::size_t frame) {
+        return fd.getCoords(frame);
+      },
+      py::arg("frame"),
+      R"delim(
+        get the vertex coordinates of a frame
+      )delim");
+  mutabletrajfile.def(
+      "getCoords",
+      [](const MutableTrajFile &fd, std::size_t frame,
+         Eigen::Ref<EigenVectorX3dr> out) { fd.getCoords(frame, out); },
+      py::arg("frame"), py::arg("out").noconvert(),
+      R"delim(
+        read the vertex coordinates of a frame into a C contiguous float64
+        array of shape (nVertices, 3) without intermediate copies
+      )delim");
+  mutabletrajfile.def(
+      "getVelocity",
+      [](const MutableTrajFile &fd, std::size_t frame,
+         Eigen::Ref<EigenVectorX3dr> out) { fd.getVelocity(frame, out); },
+      py::arg("frame"), py::arg("out").noconvert(),
+      R"delim(
+        read the vertex velocities of a frame into a C contiguous float64
+        array of shape (nVertices, 3) without intermediate copies
+      )delim");
+  mutabletrajfile.def(
+      "getProteinDensity",
+      [](const MutableTrajFile &fd, std::size_t frame,
+         Eigen::Ref<EigenVectorX1d> out) { fd.getProteinDensity(frame, out); },
+      py::arg("frame"), py::arg("out").noconvert(),
+      R"delim(
+        read the protein density of a frame into a float64 array of shape
+        (nVertices,) without intermediate copies
+      )delim");
 #endif
 
   /**
@@ -0,0 +1,240 @@
+// Membrane Dynamics in 3D using Discrete Differential Geometry (Mem3DG)
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Copyright (c) 2020:
+//     Laboratory for Computational Cellular Mechanobiology
+//     Cuncheng Zhu (cuzhu@eng.ucsd.edu)
+//     Christopher T. Lee (ctlee@ucsd.edu)
+//     Ravi Ramamoorthi (ravir@cs.ucsd.edu)
+//     Padmini Rangamani (prangamani@eng.ucsd.edu)
+//
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "mem3dg/macros.h"
+#include "mem3dg/solver/barnes_hut.h"
+
+namespace mem3dg {
+namespace solver {
+
+void BarnesHutTree::build(const Eigen::Ref<const EigenVectorX3dr> &positions,
+                          const Eigen::Ref<const EigenVectorX1d> &charges_,
+                          const std::vector<std::size_t> &exclusionStart,
+                          const std::vector<std::size_t> &exclusions,
+                          std::size_t leafSize_) {
+  if (positions.rows() != charges_.rows()) {
+    mem3dg_runtime_error("Number of positions and charges do not match!");
+  }
+  if (exclusionStart.size() != std::size_t(positions.rows()) + 1) {
+    mem3dg_runtime_error("Number of positions and exclusion rows mismatch!");
+  }
+  if (leafSize_ == 0) {
+    mem3dg_runtime_error("Leaf size of the octree has to be positive!");
+  }
+  points = positions;
+  charges = charges_;
+  leafSize = leafSize_;
+
+  const std::size_t nPoints = points.rows();
+  sortedPoints.resize(nPoints);
+  std::iota(sortedPoints.begin(), sortedPoints.end(), 0);
+  nodes.clear();
+  if (nPoints == 0)
+    return;
+
+  // root cube enclosing all points
+  Eigen::Vector3d lower = points.colwise().minCoeff().transpose();
+  Eigen::Vector3d upper = points.colwise().maxCoeff().transpose();
+  Node root;
+  root.center = 0.5 * (lower + upper);
+  root.halfWidth = std::max(0.5 * (upper - lower).maxCoeff(), 1e-12);
+  root.charge = 0;
+  root.chargeCenter = root.center;
+  root.begin = 0;
+  root.end = nPoints;
+  root.firstChild = 0;
+  nodes.reserve(2 * nPoints / leafSize + 8);
+  nodes.push_back(root);
+  subdivide(0, 0);
+
+  // symmetric exclusion table in terms of positions in sortedPoints, so that
+  // whether a node holds an excluded neighbor is a search in a sorted row
+  std::vector<std::size_t> ranks(nPoints);
+  for (std::size_t k = 0; k < nPoints; ++k) {
+    ranks[sortedPoints[k]] = k;
+  }
+  excludedStart.assign(nPoints + 1, 0);
+  for (std::size_t i = 0; i < nPoints; ++i) {
+    for (std::size_t k = exclusionStart[i]; k < exclusionStart[i + 1]; ++k) {
+      ++excludedStart[i + 1];
+      ++excludedStart[exclusions[k] + 1];
+    }
+  }
+  std::partial_sum(excludedStart.begin(), excludedStart.end(),
+                   excludedStart.begin());
+  excludedRanks.resize(excludedStart[nPoints]);
+  std::vector<std::size_t> cursor(excludedStart.begin(),
+                                  excludedStart.end() - 1);
+  for (std::size_t i = 0; i < nPoints; ++i) {
+    for (std::size_t k = exclusionStart[i]; k < exclusionStart[i + 1]; ++k) {
+      std::size_t j = exclusions[k];
+      excludedRanks[cursor[i]++] = ranks[j];
+      excludedRanks[cursor[j]++] = ranks[i];
+    }
+  }
+  for (std::size_t i = 0; i < nPoints; ++i) {
+    std::sort(excludedRanks.begin() + excludedStart[i],
+              excludedRanks.begin() + excludedStart[i + 1]);
+  }
+}
+
+void BarnesHutTree::subdivide(std::size_t nodeIndex, std::size_t depth) {
+  // coincident points can not be separated, stop at a fixed depth
+  const std::size_t maxDepth = 32;
+
+  // monopole of the node
+  const std::size_t begin = nodes[nodeIndex].begin;
+  const std::size_t end = nodes[nodeIndex].end;
+  double charge = 0;
+  double weight = 0;
+  Eigen::Vector3d weightedCenter = Eigen::Vector3d::Zero();
+  Eigen::Vector3d geometricCenter = Eigen::Vector3d::Zero();
+  for (std::size_t k = begin; k < end; ++k) {
+    std::size_t j = sortedPoints[k];
+    charge += charges[j];
+    weight += std::abs(charges[j]);
+    weightedCenter += std::abs(charges[j]) * points.row(j).transpose();
+    geometricCenter += points.row(j).transpose();
+  }
+  nodes[nodeIndex].charge = charge;
+  nodes[nodeIndex].chargeCenter =
+      (weight > 0) ? Eigen::Vector3d(weightedCenter / weight)
+                   : Eigen::Vector3d(geometricCenter / (end - begin));
+
+  if (end - begin <= leafSize || depth >= maxDepth)
+    return;
+
+  // partition the range into octants
+  const Eigen::Vector3d center = nodes[nodeIndex].center;
+  const double halfWidth = nodes[nodeIndex].halfWidth;
+  auto octant = [&](std::size_t j) {
+    return int(points(j, 0) >= center[0]) |
+           (int(points(j, 1) >= center[1]) << 1) |
+           (int(points(j, 2) >= center[2]) << 2);
+  };
+  std::array<std::size_t, 9> offsets{};
+  for (std::size_t k = begin; k < end; ++k) {
+    ++offsets[octant(sortedPoints[k]) + 1];
+  }
+  for (std::size_t o = 0; o < 8; ++o) {
+    offsets[o + 1] += offsets[o];
+  }
+  std::vector<std::size_t> partitioned(end - begin);
+  std::array<std::size_t, 8> cursor;
+  std::copy(offsets.begin(), offsets.begin() + 8, cursor.begin());
+  for (std::size_t k = begin; k < end; ++k) {
+    partitioned[cursor[octant(sortedPoints[k])]++] = sortedPoints[k];
+  }
+  std::copy(partitioned.begin(), partitioned.end(),
+            sortedPoints.begin() + begin);
+
+  // create the children, note that nodes may be reallocated
+  const std::size_t firstChild = nodes.size();
+  nodes[nodeIndex].firstChild = firstChild;
+  for (std::size_t o = 0; o < 8; ++o) {
+    Node child;
+    child.halfWidth = 0.5 * halfWidth;
+    child.center =
+        center + child.halfWidth * Eigen::Vector3d((o & 1) ? 1 : -1,
+                                                   (o & 2) ? 1 : -1,
+                                                   (o & 4) ? 1 : -1);
+    child.charge = 0;
+    child.chargeCenter = child.center;
+    child.begin = begin + offsets[o];
+    child.end = begin + offsets[o + 1];
+    child.firstChild = 0;
+    nodes.push_back(child);
+  }
+  for (std::size_t o = 0; o < 8; ++o) {
+    if (nodes[firstChild + o].end > nodes[firstChild + o].begin)
+      subdivide(firstChild + o, depth + 1);
+  }
+}
+
+void BarnesHutTree::evaluate(double theta, double d0,
+                             EigenVectorX1d &potential,
+                             EigenVectorX3dr &field) const {
+  const std::size_t nPoints = points.rows();
+  potential.setZero(nPoints);
+  field.setZero(nPoints, 3);
+  if (nodes.empty())
+    return;
+
+  std::vector<std::size_t> stack;
+  stack.reserve(8 * 32);
+  for (std::size_t i = 0; i < nPoints; ++i) {
+    const Eigen::Vector3d x = points.row(i).transpose();
+    double pot = 0;
+    Eigen::Vector3d grad = Eigen::Vector3d::Zero();
+    const auto excludedBegin = excludedRanks.begin() + excludedStart[i];
+    const auto excludedEnd = excludedRanks.begin() + excludedStart[i + 1];
+
+    stack.clear();
+    stack.push_back(0);
+    while (!stack.empty()) {
+      const Node &node = nodes[stack.back()];
+      stack.pop_back();
+      if (node.begin == node.end)
+        continue;
+
+      // first excluded neighbor at or after the node range
+      auto excluded = std::lower_bound(excludedBegin, excludedEnd, node.begin);
+
+      if (node.firstChild == 0) {
+        // leaf, direct summation, walk the sorted exclusions along with k
+        for (std::size_t k = node.begin; k < node.end; ++k) {
+          if (excluded != excludedEnd && *excluded == k) {
+            ++excluded;
+            continue;
+          }
+          std::size_t j = sortedPoints[k];
+          if (j == i)
+            continue;
+          Eigen::Vector3d r = points.row(j).transpose() - x;
+          double rNorm = r.norm();
+          double distance = rNorm - d0;
+          pot += charges[j] / distance;
+          grad += charges[j] / distance / distance / rNorm * r;
+        }
+        continue;
+      }
+
+      Eigen::Vector3d r = node.chargeCenter - x;
+      double rNorm = r.norm();
+      double distance = rNorm - d0;
+      bool isInside =
+          ((x - node.center).cwiseAbs().array() <= node.halfWidth).all();
+      bool isExcluding = excluded != excludedEnd && *excluded < node.end;
+      if (!isInside && !isExcluding && distance > 0 &&
+          2 * node.halfWidth < theta * rNorm) {
+        // far field, monopole approximation
+        pot += node.charge / distance;
+        grad += node.charge / distance / distance / rNorm * r;
+      } else {
+        for (std::size_t o = 0; o < 8; ++o) {
+          stack.push_back(node.firstChild + o);
+        }
+      }
+    }
+    potential[i] = pot;
+    field.row(i) = grad.transpose();
+  }
+}
+
+} // namespace solver
+} // namespace mem3dg
@@ -0,0 +1,68 @@
+// Membrane Dynamics in 3D using Discrete Differential Geometry (Mem3DG)
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Copyright (c) 2020:
+//     Laboratory for Computational Cellular Mechanobiology
+//     Cuncheng Zhu (cuzhu@eng.ucsd.edu)
+//     Christopher T. Lee (ctlee@ucsd.edu)
+//     Ravi Ramamoorthi (ravir@cs.ucsd.edu)
+//     Padmini Rangamani (prangamani@eng.ucsd.edu)
+//
+
+#include <cmath>
+#include <cstddef>
+
+#include "mem3dg/constants.h"
+#include "mem3dg/solver/counter_rng.h"
+
+namespace mem3dg {
+namespace solver {
+
+Philox4x32::Counter Philox4x32::generate(Counter counter, Key key) {
+  const std::uint32_t M0 = 0xD2511F53, M1 = 0xCD9E8D57;
+  const std::uint32_t W0 = 0x9E3779B9, W1 = 0xBB67AE85;
+  for (int round = 0; round < 10; ++round) {
+    if (round > 0) {
+      key[0] += W0;
+      key[1] += W1;
+    }
+    const std::uint64_t p0 = std::uint64_t(M0) * counter[0];
+    const std::uint64_t p1 = std::uint64_t(M1) * counter[2];
+    counter = {std::uint32_t(p1 >> 32) ^ counter[1] ^ key[0],
+               std::uint32_t(p1),
+               std::uint32_t(p0 >> 32) ^ counter[3] ^ key[1],
+               std::uint32_t(p0)};
+  }
+  return counter;
+}
+
+void Philox4x32::fillNormal(std::uint64_t seed, std::uint64_t step,
+                            Eigen::Ref<EigenVectorX1d> normal) {
+  const Key key{std::uint32_t(seed), std::uint32_t(seed >> 32)};
+  const std::ptrdiff_t nBlocks = (normal.rows() + 1) / 2;
+  // 53-bit uniform in (0, 1]
+  auto uniform = [](std::uint32_t hi, std::uint32_t lo) {
+    const double scale = 1.0 / 9007199254740992.0;
+    return (double((std::uint64_t(hi) << 21) ^ (lo >> 11)) + 1) * scale;
+  };
+#ifdef MEM3DG_WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (std::ptrdiff_t b = 0; b < nBlocks; ++b) {
+    const Counter bits =
+        generate({std::uint32_t(b), std::uint32_t(std::uint64_t(b) >> 32),
+                  std::uint32_t(step), std::uint32_t(step >> 32)},
+                 key);
+    const double radius = std::sqrt(-2 * std::log(uniform(bits[0], bits[1])));
+    const double angle = 2 * constants::PI * uniform(bits[2], bits[3]);
+    normal[2 * b] = radius * std::cos(angle);
+    if (2 * b + 1 < normal.rows())
+      normal[2 * b + 1] = radius * std::sin(angle);
+  }
+}
+
+} // namespace solver
+} // namespace mem3dg
@@ -140,35 +140,38 @@ void System::computeProteinInteriorPenalty() {
 void System::computeSelfAvoidanceEnergy() {
   const double d0 = parameters.selfAvoidance.d;
   const double mu = parameters.selfAvoidance.mu;
-  const double n = parameters.selfAvoidance.n;
   double e = 0.0;
   projectedCollideTime = std::numeric_limits<double>::max();
-  for (std::size_t i = 0; i < mesh->nVertices(); ++i) {
-    gc::Vertex vi{mesh->vertex(i)};
-    gc::VertexData<bool> neighborList(*mesh, false);
-    meshProcessor.meshMutator.markVertices(neighborList, vi, n);
-    for (std::size_t j = i + 1; j < mesh->nVertices(); ++j) {
-      if (neighborList[j])
-        continue;
-      gc::Vertex vj{mesh->vertex(j)};
-
-      // double penalty = mu * vpg->vertexDualAreas[vi] * proteinDensity[vi] *
-      //                  vpg->vertexDualAreas[vj] * proteinDensity[vj];
-      double penalty = mu * proteinDensity[vi] * proteinDensity[vj];
+  auto updateCollideTime = [&](std::size_t i, std::size_t j) {
+    gc::Vector3 r = vpg->inputVertexPositions[j] - vpg->inputVertexPositions[i];
+    double distance = gc::norm(r) - d0;
+    double collideTime = distance / gc::dot(velocity[i] - velocity[j], r);
+    if (collideTime < projectedCollideTime &&
+        gc::dot(velocity[i] - velocity[j], r) > 0)
+      projectedCollideTime = collideTime;
+    return distance;
+  };
+  if (parameters.selfAvoidance.theta > 0) {
+    updateSelfAvoidanceField();
+    // every pair is counted from both ends
+    e = 0.5 * mu * proteinDensity.raw().dot(selfAvoidancePotential);
+    // collision is only foreseeable among the near field pairs. Without a
+    // cutoff there are none and projectedCollideTime stays 0, i.e. no
+    // foreseeable collision, so forward Euler updates the force every step
+    if (parameters.selfAvoidance.cutoff > 0)
+      forEachSelfAvoidancePair(updateCollideTime);
+  } else {
+    forEachSelfAvoidancePair([&](std::size_t i, std::size_t j) {
+      // double penalty = mu * vpg->vertexDualAreas[i] * proteinDensity[i] *
+      //                  vpg->vertexDualAreas[j] * proteinDensity[j];
+      double penalty = mu * proteinDensity[i] * proteinDensity[j];
       // double penalty = mu;
-      // double penalty = mu * vpg->vertexDualAreas[vi] *
-      // vpg->vertexDualAreas[vj];
-
-      gc::Vector3 r =
-          vpg->inputVertexPositions[vj] - vpg->inputVertexPositions[vi];
-      double distance = gc::norm(r) - d0;
-      double collideTime = distance / gc::dot(velocity[vi] - velocity[vj], r);
-      if (collideTime < projectedCollideTime &&
-          gc::dot(velocity[vi] - velocity[vj], r) > 0)
-        projectedCollideTime = collideTime;
+      // double penalty = mu * vpg->vertexDualAreas[i] *
+      // vpg->vertexDualAreas[j];
+      double distance = updateCollideTime(i, j);
       // e -= penalty * log(distance);
       e += penalty / distance;
-    }
+    });
   }
   if (projectedCollideTime == std::numeric_limits<double>::max())
     projectedCollideTime = 0;
@@ -203,6 +206,9 @@ void System::computeDirichletEnergy() {
 }
 
 double System::computePotentialEnergy() {
+  // terms may have been switched on since the last refresh
+  requireGeometricQuantities(activeGeometricQuantities());
+
   // fundamental internal potential energy
   energy.bendingEnergy = 0;
   energy.deviatoricEnergy = 0;
@@ -219,7 +225,9 @@ double System::computePotentialEnergy() {
   computePressureEnergy();
 
   // optional internal potential energy
-  computeDeviatoricEnergy();
+  if (parameters.bending.Kd != 0 || parameters.bending.Kdc != 0) {
+    computeDeviatoricEnergy();
+  }
   if (parameters.adsorption.epsilon != 0) {
     computeAdsorptionEnergy();
   }
@@ -14,9 +14,15 @@
 
 // uncomment to disable assert()
 // #define NDEBUG
+#include <algorithm>
 #include <cassert>
 #include <cmath>
+#include <cstddef>
+#include <cstdint>
 #include <iostream>
+#include <limits>
+#include <type_traits>
+#include <utility>
 
 #include <geometrycentral/numerical/linear_solvers.h>
 #include <geometrycentral/surface/halfedge_mesh.h>
@@ -238,15 +244,94 @@ gcs::VertexData<gc::Vector3> System::halfedgeVectorToVertexVector(
   return vector;
 }
 
+namespace {
+/**
+ * @brief Call f with the compile time constant equal to the runtime bitmask of
+ * mechanical terms, so that disabled terms are compiled out of the kernel
+ */
+template <unsigned Terms, typename Function>
+typename std::enable_if<(Terms > MechanicalTerm::All)>::type
+dispatchMechanicalTerms(unsigned, Function &&) {
+  mem3dg_runtime_error("Invalid mechanical terms!");
+}
+template <unsigned Terms = 0, typename Function>
+typename std::enable_if<(Terms <= MechanicalTerm::All)>::type
+dispatchMechanicalTerms(unsigned terms, Function &&f) {
+  if (terms == Terms) {
+    f(std::integral_constant<unsigned, Terms>());
+  } else {
+    dispatchMechanicalTerms<Terms + 1>(terms, std::forward<Function>(f));
+  }
+}
+} // namespace
+
+unsigned System::activeMechanicalTerms() const {
+  unsigned terms = 0;
+  if (parameters.bending.Kd != 0 || parameters.bending.Kdc != 0)
+    terms |= MechanicalTerm::Deviatoric;
+  if (parameters.dirichlet.eta != 0)
+    terms |= MechanicalTerm::Dirichlet;
+  if (parameters.adsorption.epsilon != 0)
+    terms |= MechanicalTerm::Adsorption;
+  if (parameters.aggregation.chi != 0)
+    terms |= MechanicalTerm::Aggregation;
+  return terms;
+}
+
+void System::updateHalfedgeVariationalVectors() {
+  const bool isDeviatoric =
+      activeMechanicalTerms() & MechanicalTerm::Deviatoric;
+  // every halfedge only writes to its own entries
+  const std::ptrdiff_t nHalfedges = mesh->nHalfedges();
+#ifdef MEM3DG_WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (std::ptrdiff_t i = 0; i < nHalfedges; ++i) {
+    updateHalfedgeVariationalVectors(mesh->halfedge(i), isDeviatoric);
+  }
+}
+
+void System::updateHalfedgeVariationalVectors(gcs::Halfedge he,
+                                              bool isDeviatoric) {
+  halfedgeAreaGradient[he] = 2 * computeHalfedgeMeanCurvatureVector(*vpg, he);
+  halfedgeGaussianCurvatureVector[he] =
+      computeHalfedgeGaussianCurvatureVector(*vpg, he);
+  // dihedral angle gradient wrt the tail vertex and the vertex opposite to the
+  // halfedge, scaled by edge length. Together they cover all four vertices of
+  // the edge stencil
+  halfedgeSchlafliTail[he] =
+      vpg->edgeLengths[he.edge()] * dihedralAngleGradient(he, he.vertex());
+  halfedgeSchlafliOpposite[he] =
+      vpg->edgeLengths[he.edge()] *
+      dihedralAngleGradient(he, he.next().next().vertex());
+  // corner angle gradients, the three combinations of each halfedge cover all
+  // nine (corner, vertex) pairs of the face. Only the deviatoric term uses them
+  if (isDeviatoric && he.isInterior()) {
+    halfedgeCornerGradientSelf[he] =
+        cornerAngleGradient(he.corner(), he.vertex());
+    halfedgeCornerGradientNext[he] =
+        cornerAngleGradient(he.next().corner(), he.vertex());
+    halfedgeCornerGradientTip[he] =
+        cornerAngleGradient(he.corner(), he.next().vertex());
+  } else {
+    halfedgeCornerGradientSelf[he] = gc::Vector3{0, 0, 0};
+    halfedgeCornerGradientNext[he] = gc::Vector3{0, 0, 0};
+    halfedgeCornerGradientTip[he] = gc::Vector3{0, 0, 0};
+  }
+}
+
 void System::computeMechanicalForces() {
   assert(mesh->isCompressed());
   // if(!mesh->isCompressed()){
   //   mem3dg_runtime_error("Mesh must be compressed to compute forces!");
   // }
 
-  for (std::size_t i = 0; i < mesh->nVertices(); ++i) {
-    computeMechanicalForces(i);
-  }
+  // geometric primitives shared by the vertex stencils are evaluated once
+  updateHalfedgeVariationalVectors();
+
+  dispatchMechanicalTerms(activeMechanicalTerms(), [this](auto terms) {
+    this->template assembleMechanicalForces<decltype(terms)::value>();
+  });
 
   // measure smoothness
   // if (meshProcessor.meshMutator.isSplitEdge ||
@@ -261,60 +346,144 @@ void System::computeMechanicalForces(gcs::Vertex &v) {
 }
 
 void System::computeMechanicalForces(size_t i) {
+  const unsigned terms = activeMechanicalTerms();
+  const bool isDeviatoric = terms & MechanicalTerm::Deviatoric;
+  // refresh the halfedge vectors read by the stencil of the vertex
+  gc::Vertex v{mesh->vertex(i)};
+  for (gc::Halfedge he : v.outgoingHalfedges()) {
+    updateHalfedgeVariationalVectors(he, isDeviatoric);
+    updateHalfedgeVariationalVectors(he.next(), isDeviatoric);
+    updateHalfedgeVariationalVectors(he.twin(), isDeviatoric);
+    updateHalfedgeVariationalVectors(he.twin().next().next(), isDeviatoric);
+  }
+  dispatchMechanicalTerms(terms, [this, i](auto terms) {
+    this->template assembleMechanicalForces<decltype(terms)::value>(i);
+  });
+}
+
+template <unsigned Terms> void System::assembleMechanicalForces() {
+  // Each vertex only writes to its own row of the force buffers and reads
+  // geometry that is constant during assembly, so the loop is race free and
+  // the result does not depend on the number of threads
+  const std::ptrdiff_t nVertices = mesh->nVertices();
+#ifdef MEM3DG_WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (std::ptrdiff_t i = 0; i < nVertices; ++i) {
+    assembleMechanicalForces<Terms>(static_cast<std::size_t>(i));
+  }
+}
+
+template <unsigned Terms> void System::assembleMechanicalForces(size_t i) {
   gc::Vertex v{mesh->vertex(i)};
-  gc::Vector3 bendingForceVec{0, 0, 0};
-  gc::Vector3 bendingForceVec_areaGrad{0, 0, 0};
-  gc::Vector3 bendingForceVec_gaussVec{0, 0, 0};
-  gc::Vector3 bendingForceVec_schlafliVec{0, 0, 0};
-
-  gc::Vector3 deviatoricForceVec{0, 0, 0};
-  gc::Vector3 deviatoricForceVec_mean{0, 0, 0};
-  gc::Vector3 deviatoricForceVec_gauss{0, 0, 0};
-
-  gc::Vector3 capillaryForceVec{0, 0, 0};
-  gc::Vector3 osmoticForceVec{0, 0, 0};
-  gc::Vector3 lineCapForceVec{0, 0, 0};
-  gc::Vector3 adsorptionForceVec{0, 0, 0};
-  gc::Vector3 aggregationForceVec{0, 0, 0};
+  MechanicalForceContribution contribution;
+  for (gc::Halfedge he : v.outgoingHalfedges()) {
+    accumulateHalfedgeMechanicalForces<Terms>(he, contribution);
+  }
+  storeMechanicalForces(i, contribution);
+}
+
+void System::updateEdgeColoring() {
+  if (!isEdgeColoringOutdated && coloredEdges.size() == mesh->nEdges())
+    return;
+
+  // greedy coloring, the smallest color not used by the colored edges at
+  // either end. Up to 2 * (maximum valence) - 1 colors may be needed
+  const std::size_t uncolored = std::numeric_limits<std::size_t>::max();
+  std::vector<std::size_t> edgeColors(mesh->nEdges(), uncolored);
+  std::vector<bool> isUsed;
+  std::size_t nColors = 0;
+  for (std::size_t e = 0; e < mesh->nEdges(); ++e) {
+    gc::Halfedge he = mesh->edge(e).halfedge();
+    isUsed.assign(nColors + 1, false);
+    for (gc::Vertex v : {he.tailVertex(), he.tipVertex()}) {
+      for (gc::Edge ne : v.adjacentEdges()) {
+        if (edgeColors[ne.getIndex()] != uncolored)
+          isUsed[edgeColors[ne.getIndex()]] = true;
+      }
+    }
+    std::size_t color = 0;
+    while (isUsed[color])
+      ++color;
+    edgeColors[e] = color;
+    nColors = std::max(nColors, color + 1);
+  }
+
+  // group the edges by color in compressed rows
+  edgeColorStart.assign(nColors + 1, 0);
+  for (std::size_t e = 0; e < mesh->nEdges(); ++e) {
+    ++edgeColorStart[edgeColors[e] + 1];
+  }
+  for (std::size_t color = 0; color < nColors; ++color) {
+    edgeColorStart[color + 1] += edgeColorStart[color];
+  }
+  coloredEdges.resize(mesh->nEdges());
+  std::vector<std::size_t> cursor(edgeColorStart.begin(),
+                                  edgeColorStart.end() - 1);
+  for (std::size_t e = 0; e < mesh->nEdges(); ++e) {
+    coloredEdges[cursor[edgeColors[e]]++] = e;
+  }
+
+  isEdgeColoringOutdated = false;
+}
+
+template <unsigned Terms>
+void System::accumulateHalfedgeMechanicalForces(
+    gcs::Halfedge he, MechanicalForceContribution &contribution) {
+  // terms excluded from the bitmask are compiled out, including their geometric
+  // primitives
+  constexpr bool isDeviatoric = Terms & MechanicalTerm::Deviatoric;
+  constexpr bool isDirichlet = Terms & MechanicalTerm::Dirichlet;
+  constexpr bool isAdsorption = Terms & MechanicalTerm::Adsorption;
+  constexpr bool isAggregation = Terms & MechanicalTerm::Aggregation;
+
+  gc::Vertex v = he.vertex();
+  std::size_t i = v.getIndex();
   double Hi = vpg->vertexMeanCurvatures[i] / vpg->vertexDualAreas[i];
   double H0i = H0[i];
   double Kbi = Kb[i];
-  double Kdi = Kd[i];
   double proteinDensityi = proteinDensity[i];
-  bool boundaryVertex = v.isBoundary();
 
-  for (gc::Halfedge he : v.outgoingHalfedges()) {
-    std::size_t fID = he.face().getIndex();
-
-    // Initialize local variables for computation
-    std::size_t i_vj = he.tipVertex().getIndex();
-
-    gc::Vector3 dphi_ijk{he.isInterior() ? proteinDensityGradient[fID]
-                                         : gc::Vector3{0, 0, 0}};
-    double Hj = vpg->vertexMeanCurvatures[i_vj] / vpg->vertexDualAreas[i_vj];
-    double H0j = H0[i_vj];
-    double Kbj = Kb[i_vj];
-    double Kdj = Kd[i_vj];
-    double proteinDensityj = proteinDensity[i_vj];
-    bool interiorHalfedge = he.isInterior();
-    bool boundaryEdge = he.edge().isBoundary();
-    bool boundaryNeighborVertex = he.next().vertex().isBoundary();
-
-    gc::Vector3 areaGrad = 2 * computeHalfedgeMeanCurvatureVector(*vpg, he);
-    gc::Vector3 gaussVec = computeHalfedgeGaussianCurvatureVector(*vpg, he);
-    gc::Vector3 schlafliVec1;
-    gc::Vector3 schlafliVec2;
-    // std::tie(schlafliVec1, schlafliVec2) =
-    //     computeHalfedgeSchlafliVector(*vpg, he);
-    schlafliVec1 =
-        vpg->edgeLengths[he.edge()] * dihedralAngleGradient(he, he.vertex());
-    schlafliVec2 =
-        vpg->edgeLengths[he.twin().edge()] *
-            dihedralAngleGradient(he.twin(), he.vertex()) +
-        vpg->edgeLengths[he.next().edge()] *
-            dihedralAngleGradient(he.next(), he.vertex()) +
-        vpg->edgeLengths[he.twin().next().next().edge()] *
-            dihedralAngleGradient(he.twin().next().next(), he.vertex());
+  std::size_t fID = he.face().getIndex();
+
+  // Initialize local variables for computation
+  std::size_t i_vj = he.tipVertex().getIndex();
+
+  double Hj = vpg->vertexMeanCurvatures[i_vj] / vpg->vertexDualAreas[i_vj];
+  double H0j = H0[i_vj];
+  double Kbj = Kb[i_vj];
+  double proteinDensityj = proteinDensity[i_vj];
+  bool interiorHalfedge = he.isInterior();
+
+  const gc::Vector3 &areaGrad = halfedgeAreaGradient[he];
+  const gc::Vector3 &gaussVec = halfedgeGaussianCurvatureVector[he];
+  // std::tie(schlafliVec1, schlafliVec2) =
+  //     computeHalfedgeSchlafliVector(*vpg, he);
+  // Note: the gradient of the dihedral angle of the edge wrt vi is the same
+  // viewed from both halfedges
+  gc::Vector3 schlafliVec1 = halfedgeSchlafliTail[he];
+  gc::Vector3 schlafliVec2 = halfedgeSchlafliTail[he] +
+                             halfedgeSchlafliOpposite[he.next()] +
+                             halfedgeSchlafliOpposite[he.twin().next().next()];
+
+  // Assemble to forces
+  contribution.osmoticForceVec +=
+      forces.osmoticPressure * computeHalfedgeVolumeVariationVector(*vpg, he);
+  contribution.capillaryForceVec -= forces.surfaceTension * areaGrad;
+  if (isAdsorption) {
+    contribution.adsorptionForceVec -=
+        (proteinDensityi / 3 + proteinDensityj * 2 / 3) *
+        parameters.adsorption.epsilon * areaGrad;
+  }
+  if (isAggregation) {
+    contribution.aggregationForceVec -=
+        (proteinDensityi * proteinDensityi / 3 +
+         proteinDensityj * proteinDensityj * 2 / 3) *
+        parameters.aggregation.chi * areaGrad;
+  }
+  if (isDirichlet) {
+    gc::Vector3 dphi_ijk{interiorHalfedge ? proteinDensityGradient[fID]
+                                          : gc::Vector3{0, 0, 0}};
     gc::Vector3 oneSidedAreaGrad{0, 0, 0};
     gc::Vector3 dirichletVec{0, 0, 0};
     if (interiorHalfedge) {
@@ -323,85 +492,120 @@ void System::computeMechanicalForces(size_t i) {
       dirichletVec = computeGradientNorm2Gradient(he, proteinDensity) /
                      vpg->faceAreas[fID];
     }
-
-    // Assemble to forces
-    osmoticForceVec +=
-        forces.osmoticPressure * computeHalfedgeVolumeVariationVector(*vpg, he);
-    capillaryForceVec -= forces.surfaceTension * areaGrad;
-    adsorptionForceVec -= (proteinDensityi / 3 + proteinDensityj * 2 / 3) *
-                          parameters.adsorption.epsilon * areaGrad;
-    aggregationForceVec -= (proteinDensityi * proteinDensityi / 3 +
-                            proteinDensityj * proteinDensityj * 2 / 3) *
-                           parameters.aggregation.chi * areaGrad;
-    lineCapForceVec -=
+    contribution.lineCapForceVec -=
         parameters.dirichlet.eta *
         (0.125 * dirichletVec - 0.5 * dphi_ijk.norm2() * oneSidedAreaGrad);
+  }
 
-    bendingForceVec_schlafliVec -=
-        (Kbi * (Hi - H0i) * schlafliVec1 + Kbj * (Hj - H0j) * schlafliVec2);
-    bendingForceVec_areaGrad -= (Kbi * (H0i * H0i - Hi * Hi) / 3 +
-                                 Kbj * (H0j * H0j - Hj * Hj) * 2 / 3) *
-                                areaGrad;
-    bendingForceVec_gaussVec -=
-        (Kbi * (Hi - H0i) + Kbj * (Hj - H0j)) * gaussVec;
-
-    deviatoricForceVec_mean -=
-        (Kdi * Hi + Kdj * Hj) * gaussVec +
-        (Kdi * (-Hi * Hi) / 3 + Kdj * (-Hj * Hj) * 2 / 3) * areaGrad +
-        (Kdi * Hi * schlafliVec1 + Kdj * Hj * schlafliVec2);
-
-    // bool interiorTwinHalfedge = he.twin().isInterior();
-    // if (interiorHalfedge) {
-    //   deviatoricForceVec_gauss -=
-    //       Kdi * cornerAngleGradient(he.corner(), he.vertex()) +
-    //       Kdj * cornerAngleGradient(he.next().corner(), he.vertex());
-    // }
-    // if (interiorTwinHalfedge) {
-    //   deviatoricForceVec_gauss -=
-    //       Kdj * cornerAngleGradient(he.twin().corner(), he.vertex());
-    // }
-    if (boundaryVertex) {
-      if (!boundaryEdge)
-        deviatoricForceVec_gauss -=
-            Kdj * cornerAngleGradient(he.next().corner(), he.vertex()) +
-            Kdj * cornerAngleGradient(he.twin().corner(), he.vertex());
+  contribution.bendingForceVec_schlafliVec -=
+      (Kbi * (Hi - H0i) * schlafliVec1 + Kbj * (Hj - H0j) * schlafliVec2);
+  contribution.bendingForceVec_areaGrad -=
+      (Kbi * (H0i * H0i - Hi * Hi) / 3 + Kbj * (H0j * H0j - Hj * Hj) * 2 / 3) *
+      areaGrad;
+  contribution.bendingForceVec_gaussVec -=
+      (Kbi * (Hi - H0i) + Kbj * (Hj - H0j)) * gaussVec;
+
+  if (!isDeviatoric)
+    return;
+
+  double Kdi = Kd[i];
+  double Kdj = Kd[i_vj];
+  bool boundaryVertex = v.isBoundary();
+  bool boundaryEdge = he.edge().isBoundary();
+  bool boundaryNeighborVertex = he.next().vertex().isBoundary();
+
+  contribution.deviatoricForceVec_mean -=
+      (Kdi * Hi + Kdj * Hj) * gaussVec +
+      (Kdi * (-Hi * Hi) / 3 + Kdj * (-Hj * Hj) * 2 / 3) * areaGrad +
+      (Kdi * Hi * schlafliVec1 + Kdj * Hj * schlafliVec2);
+
+  // bool interiorTwinHalfedge = he.twin().isInterior();
+  // if (interiorHalfedge) {
+  //   deviatoricForceVec_gauss -=
+  //       Kdi * cornerAngleGradient(he.corner(), he.vertex()) +
+  //       Kdj * cornerAngleGradient(he.next().corner(), he.vertex());
+  // }
+  // if (interiorTwinHalfedge) {
+  //   deviatoricForceVec_gauss -=
+  //       Kdj * cornerAngleGradient(he.twin().corner(), he.vertex());
+  // }
+  if (boundaryVertex) {
+    if (!boundaryEdge)
+      contribution.deviatoricForceVec_gauss -=
+          Kdj * halfedgeCornerGradientNext[he] +
+          Kdj * halfedgeCornerGradientTip[he.twin()];
+  } else {
+    if (boundaryNeighborVertex) {
+      contribution.deviatoricForceVec_gauss -=
+          Kdi * halfedgeCornerGradientSelf[he];
     } else {
-      if (boundaryNeighborVertex) {
-        deviatoricForceVec_gauss -=
-            Kdi * cornerAngleGradient(he.corner(), he.vertex());
-      } else {
-        deviatoricForceVec_gauss -=
-            Kdi * cornerAngleGradient(he.corner(), he.vertex()) +
-            Kdj * cornerAngleGradient(he.next().corner(), he.vertex()) +
-            Kdj * cornerAngleGradient(he.twin().corner(), he.vertex());
-      }
+      contribution.deviatoricForceVec_gauss -=
+          Kdi * halfedgeCornerGradientSelf[he] +
+          Kdj * halfedgeCornerGradientNext[he] +
+          Kdj * halfedgeCornerGradientTip[he.twin()];
     }
   }
+}
 
-  bendingForceVec = bendingForceVec_areaGrad + bendingForceVec_gaussVec +
-                    bendingForceVec_schlafliVec;
+void System::storeMechanicalForces(
+    size_t i, const MechanicalForceContribution &contribution) {
+  gc::Vector3 bendingForceVec_areaGrad = contribution.bendingForceVec_areaGrad;
+  gc::Vector3 bendingForceVec_gaussVec = contribution.bendingForceVec_gaussVec;
+  gc::Vector3 bendingForceVec_schlafliVec =
+      contribution.bendingForceVec_schlafliVec;
+  gc::Vector3 deviatoricForceVec_mean = contribution.deviatoricForceVec_mean;
+  gc::Vector3 deviatoricForceVec_gauss = contribution.deviatoricForceVec_gauss;
+  gc::Vector3 capillaryForceVec = contribution.capillaryForceVec;
+  gc::Vector3 osmoticForceVec = contribution.osmoticForceVec;
+  gc::Vector3 lineCapForceVec = contribution.lineCapForceVec;
+  gc::Vector3 adsorptionForceVec = contribution.adsorptionForceVec;
+  gc::Vector3 aggregationForceVec = contribution.aggregationForceVec;
+
+  gc::Vector3 bendingForceVec = bendingForceVec_areaGrad +
+                                bendingForceVec_gaussVec +
+                                bendingForceVec_schlafliVec;
 
   // deviatoricForceVec = deviatoricForceVec_gauss;
   // std::cout << "gauss force: " << deviatoricForceVec_gauss << std::ends;
-  deviatoricForceVec = deviatoricForceVec_mean + deviatoricForceVec_gauss;
+  gc::Vector3 deviatoricForceVec =
+      deviatoricForceVec_mean + deviatoricForceVec_gauss;
   // deviatoricForceVec = deviatoricForceVec_mean;
 
+  // lean diagnostics, only the sum is stored. Masking is elementwise by 0 or 1
+  // and commutes with the sum
+  if (!forces.isFullDiagnostics) {
+    forces.mechanicalForceVec[i] = forces.maskForce(
+        osmoticForceVec + capillaryForceVec + bendingForceVec +
+            deviatoricForceVec + lineCapForceVec + adsorptionForceVec +
+            aggregationForceVec,
+        i);
+    return;
+  }
+
   // masking
   bendingForceVec_areaGrad = forces.maskForce(bendingForceVec_areaGrad, i);
   bendingForceVec_gaussVec = forces.maskForce(bendingForceVec_gaussVec, i);
   bendingForceVec_schlafliVec =
       forces.maskForce(bendingForceVec_schlafliVec, i);
-  bendingForceVec = forces.maskForce(bendingForceVec, i);
-
   deviatoricForceVec_mean = forces.maskForce(deviatoricForceVec_mean, i);
   deviatoricForceVec_gauss = forces.maskForce(deviatoricForceVec_gauss, i);
-  deviatoricForceVec = forces.maskForce(deviatoricForceVec, i);
 
-  osmoticForceVec = forces.maskForce(osmoticForceVec, i);
-  capillaryForceVec = forces.maskForce(capillaryForceVec, i);
-  lineCapForceVec = forces.maskForce(lineCapForceVec, i);
-  adsorptionForceVec = forces.maskForce(adsorptionForceVec, i);
-  aggregationForceVec = forces.maskForce(aggregationForceVec, i);
+  // mask, project to angle-weighted normal and sum up in one pass
+  gc::Vector3 mechanicalForceVec{0, 0, 0};
+  forces.osmoticForce[i] =
+      forces.maskProjectAccumulate(osmoticForceVec, mechanicalForceVec, i);
+  forces.capillaryForce[i] =
+      forces.maskProjectAccumulate(capillaryForceVec, mechanicalForceVec, i);
+  forces.bendingForce[i] =
+      forces.maskProjectAccumulate(bendingForceVec, mechanicalForceVec, i);
+  forces.deviatoricForce[i] =
+      forces.maskProjectAccumulate(deviatoricForceVec, mechanicalForceVec, i);
+  forces.lineCapillaryForce[i] =
+      forces.maskProjectAccumulate(lineCapForceVec, mechanicalForceVec, i);
+  forces.adsorptionForce[i] =
+      forces.maskProjectAccumulate(adsorptionForceVec, mechanicalForceVec, i);
+  forces.aggregationForce[i] =
+      forces.maskProjectAccumulate(aggregationForceVec, mechanicalForceVec, i);
 
   // Combine to one
   forces.bendingForceVec_areaGrad[i] = bendingForceVec_areaGrad;
@@ -418,15 +622,7 @@ void System::computeMechanicalForces(size_t i) {
   forces.lineCapillaryForceVec[i] = lineCapForceVec;
   forces.adsorptionForceVec[i] = adsorptionForceVec;
   forces.aggregationForceVec[i] = aggregationForceVec;
-
-  // Scalar force by projection to angle-weighted normal
-  forces.bendingForce[i] = forces.ontoNormal(bendingForceVec, i);
-  forces.deviatoricForce[i] = forces.ontoNormal(deviatoricForceVec, i);
-  forces.capillaryForce[i] = forces.ontoNormal(capillaryForceVec, i);
-  forces.osmoticForce[i] = forces.ontoNormal(osmoticForceVec, i);
-  forces.lineCapillaryForce[i] = forces.ontoNormal(lineCapForceVec, i);
-  forces.adsorptionForce[i] = forces.ontoNormal(adsorptionForceVec, i);
-  forces.aggregationForce[i] = forces.ontoNormal(aggregationForceVec, i);
+  forces.mechanicalForceVec[i] = mechanicalForceVec;
 }
 
 EigenVectorX3dr System::prescribeExternalForce() {
@@ -481,97 +677,126 @@ EigenVectorX3dr System::prescribeExternalForce() {
                          i);
   }
 #endif
-  forces.externalForce = forces.ontoNormal(forces.externalForceVec);
+  forces.ontoNormal(forces.externalForceVec, forces.externalForce);
 
   return toMatrix(forces.externalForceVec);
 }
 
+void System::updateSelfAvoidanceField() {
+  updateSelfAvoidanceExclusions();
+  const double theta = parameters.selfAvoidance.theta;
+  const double d0 = parameters.selfAvoidance.d;
+  if (!isSelfAvoidanceFieldOutdated && selfAvoidanceFieldTheta == theta &&
+      selfAvoidanceFieldD == d0 &&
+      std::size_t(selfAvoidanceFieldPositions.rows()) == mesh->nVertices() &&
+      selfAvoidanceFieldPositions == toMatrix(vpg->inputVertexPositions) &&
+      selfAvoidanceFieldDensity == proteinDensity.raw())
+    return;
+
+  barnesHutTree.build(toMatrix(vpg->inputVertexPositions),
+                      toMatrix(proteinDensity), selfAvoidanceExclusionStart,
+                      selfAvoidanceExclusions);
+  barnesHutTree.evaluate(theta, d0, selfAvoidancePotential,
+                         selfAvoidanceField);
+  selfAvoidanceFieldPositions = toMatrix(vpg->inputVertexPositions);
+  selfAvoidanceFieldDensity = proteinDensity.raw();
+  selfAvoidanceFieldTheta = theta;
+  selfAvoidanceFieldD = d0;
+  isSelfAvoidanceFieldOutdated = false;
+}
+
 void System::computeSelfAvoidanceForce() {
   forces.selfAvoidanceForceVec.fill({0, 0, 0});
   const double d0 = parameters.selfAvoidance.d;
   const double mu = parameters.selfAvoidance.mu;
-  const double n = parameters.selfAvoidance.n;
-  for (std::size_t i = 0; i < mesh->nVertices(); ++i) {
-    gc::Vertex vi{mesh->vertex(i)};
-    gc::VertexData<bool> neighborList(*mesh, false);
-    meshProcessor.meshMutator.markVertices(neighborList, vi, n);
-    for (std::size_t j = i + 1; j < mesh->nVertices(); ++j) {
-      if (neighborList[j])
-        continue;
-      gc::Vertex vj{mesh->vertex(j)};
-      // double penalty = mu * vpg->vertexDualAreas[vi] * proteinDensity[vi] *
-      //                  vpg->vertexDualAreas[vj] * proteinDensity[vj];
-      double penalty = mu * proteinDensity[vi] * proteinDensity[vj];
-      // double penalty = mu;
-      // double penalty = mu * vpg->vertexDualAreas[vi] *
-      // vpg->vertexDualAreas[vj];;
-      gc::Vector3 r =
-          vpg->inputVertexPositions[vj] - vpg->inputVertexPositions[vi];
-      double distance = gc::norm(r) - d0;
-      gc::Vector3 grad = r.normalize();
-      // forces.selfAvoidanceForceVec[i] -=
-      //     forces.maskForce(penalty / distance * grad, i);
-      // forces.selfAvoidanceForceVec[j] +=
-      //     forces.maskForce(penalty / distance * grad, j);
-      forces.selfAvoidanceForceVec[i] -=
-          forces.maskForce(penalty / distance / distance * grad, i);
-      forces.selfAvoidanceForceVec[j] +=
-          forces.maskForce(penalty / distance / distance * grad, j);
+  if (parameters.selfAvoidance.theta > 0) {
+    updateSelfAvoidanceField();
+    for (std::size_t i = 0; i < mesh->nVertices(); ++i) {
+      forces.selfAvoidanceForceVec[i] = forces.maskForce(
+          -mu * proteinDensity[i] *
+              gc::Vector3{selfAvoidanceField(i, 0), selfAvoidanceField(i, 1),
+                          selfAvoidanceField(i, 2)},
+          i);
     }
+    forces.ontoNormal(forces.selfAvoidanceForceVec,
+                      forces.selfAvoidanceForce);
+    return;
   }
-  forces.selfAvoidanceForce = forces.ontoNormal(forces.selfAvoidanceForceVec);
+  forEachSelfAvoidancePair([&](std::size_t i, std::size_t j) {
+    // double penalty = mu * vpg->vertexDualAreas[i] * proteinDensity[i] *
+    //                  vpg->vertexDualAreas[j] * proteinDensity[j];
+    double penalty = mu * proteinDensity[i] * proteinDensity[j];
+    // double penalty = mu;
+    // double penalty = mu * vpg->vertexDualAreas[i] *
+    // vpg->vertexDualAreas[j];;
+    gc::Vector3 r = vpg->inputVertexPositions[j] - vpg->inputVertexPositions[i];
+    double distance = gc::norm(r) - d0;
+    gc::Vector3 grad = r.normalize();
+    // forces.selfAvoidanceForceVec[i] -=
+    //     forces.maskForce(penalty / distance * grad, i);
+    // forces.selfAvoidanceForceVec[j] +=
+    //     forces.maskForce(penalty / distance * grad, j);
+    forces.selfAvoidanceForceVec[i] -=
+        forces.maskForce(penalty / distance / distance * grad, i);
+    forces.selfAvoidanceForceVec[j] +=
+        forces.maskForce(penalty / distance / distance * grad, j);
+  });
+  forces.ontoNormal(forces.selfAvoidanceForceVec, forces.selfAvoidanceForce);
 }
 
 void System::computeChemicalPotentials() {
-  gcs::VertexData<double> dH0dphi(*mesh, 0);
-  gcs::VertexData<double> dKbdphi(*mesh, 0);
-  gcs::VertexData<double> dKddphi(*mesh, 0);
-  auto meanCurvDiff = (vpg->vertexMeanCurvatures.raw().array() /
-                       vpg->vertexDualAreas.raw().array()) -
-                      H0.raw().array();
-
-  if (parameters.bending.relation == "linear") {
-    dH0dphi.fill(parameters.bending.H0c);
-    dKbdphi.fill(parameters.bending.Kbc);
-    dKddphi.fill(parameters.bending.Kdc);
-  } else if (parameters.bending.relation == "hill") {
-    EigenVectorX1d proteinDensitySq =
-        (proteinDensity.raw().array() * proteinDensity.raw().array()).matrix();
-    dH0dphi.raw() =
-        (2 * parameters.bending.H0c * proteinDensity.raw().array() /
-         ((1 + proteinDensitySq.array()) * (1 + proteinDensitySq.array())))
-            .matrix();
-    dKbdphi.raw() =
-        (2 * parameters.bending.Kbc * proteinDensity.raw().array() /
-         ((1 + proteinDensitySq.array()) * (1 + proteinDensitySq.array())))
-            .matrix();
-    dKddphi.raw() =
-        (2 * parameters.bending.Kdc * proteinDensity.raw().array() /
-         ((1 + proteinDensitySq.array()) * (1 + proteinDensitySq.array())))
-            .matrix();
-  }
-
-  forces.bendingPotential.raw() = forces.maskProtein(
-      -vpg->vertexDualAreas.raw().array() *
-      (meanCurvDiff * meanCurvDiff * dKbdphi.raw().array() -
-       2 * Kb.raw().array() * meanCurvDiff * dH0dphi.raw().array()));
-
-  if (parameters.bending.Kd != 0 || parameters.bending.Kdc != 0) {
-    forces.deviatoricPotential.raw() =
-        -dKddphi.raw().array() *
-        (vpg->vertexMeanCurvatures.raw().array().square() /
-             vpg->vertexDualAreas.raw().array() -
-         vpg->vertexGaussianCurvatures.raw().array());
+  const bool isLinear = parameters.bending.relation == "linear";
+  const bool isHill = parameters.bending.relation == "hill";
+  const bool isDeviatoric =
+      parameters.bending.Kd != 0 || parameters.bending.Kdc != 0;
+
+  // derivatives of the constitutive relations wrt protein density are
+  // evaluated vertexwise to avoid temporaries
+  for (std::size_t i = 0; i < mesh->nVertices(); ++i) {
+    double dH0dphi = 0, dKbdphi = 0, dKddphi = 0;
+    if (isLinear) {
+      dH0dphi = parameters.bending.H0c;
+      dKbdphi = parameters.bending.Kbc;
+      dKddphi = parameters.bending.Kdc;
+    } else if (isHill) {
+      double proteinDensitySq = proteinDensity[i] * proteinDensity[i];
+      double hill = (1 + proteinDensitySq) * (1 + proteinDensitySq);
+      dH0dphi = 2 * parameters.bending.H0c * proteinDensity[i] / hill;
+      dKbdphi = 2 * parameters.bending.Kbc * proteinDensity[i] / hill;
+      dKddphi = 2 * parameters.bending.Kdc * proteinDensity[i] / hill;
+    }
+    double meanCurvDiff =
+        vpg->vertexMeanCurvatures[i] / vpg->vertexDualAreas[i] - H0[i];
+
+    forces.bendingPotential[i] =
+        -vpg->vertexDualAreas[i] *
+        (meanCurvDiff * meanCurvDiff * dKbdphi -
+         2 * Kb[i] * meanCurvDiff * dH0dphi) *
+        forces.proteinMask[i];
+
+    forces.deviatoricPotential[i] =
+        isDeviatoric ? -dKddphi * (vpg->vertexMeanCurvatures[i] *
+                                       vpg->vertexMeanCurvatures[i] /
+                                       vpg->vertexDualAreas[i] -
+                                   vpg->vertexGaussianCurvatures[i])
+                     : 0;
   }
 
+  // potentials of inactive terms are zeroed, as lean diagnostics do not zero
+  // the component buffers and terms may be switched off during a run
   if (parameters.adsorption.epsilon != 0)
-    forces.adsorptionPotential.raw() = forces.maskProtein(
-        -parameters.adsorption.epsilon * vpg->vertexDualAreas.raw().array());
+    forces.adsorptionPotential.raw().array() =
+        -parameters.adsorption.epsilon * vpg->vertexDualAreas.raw().array() *
+        forces.proteinMask.raw().array();
+  else
+    forces.adsorptionPotential.raw().setZero();
 
   if (parameters.aggregation.chi != 0)
-    forces.aggregationPotential.raw() = forces.maskProtein(
+    forces.aggregationPotential.raw().array() =
         -2 * parameters.aggregation.chi * proteinDensity.raw().array() *
-        vpg->vertexDualAreas.raw().array());
+        vpg->vertexDualAreas.raw().array() * forces.proteinMask.raw().array();
+  else
+    forces.aggregationPotential.raw().setZero();
 
   // if (parameters.adsorption.epsilon != 0)
   //   forces.adsorptionPotential.raw() = forces.maskProtein(
@@ -582,15 +807,23 @@ void System::computeChemicalPotentials() {
   //   forces.aggregationPotential.raw() = forces.maskProtein(
   //       -2 * parameters.aggregation.chi * proteinDensity.raw().array());
 
-  if (parameters.dirichlet.eta != 0)
-    forces.diffusionPotential.raw() = forces.maskProtein(
-        -parameters.dirichlet.eta * vpg->cotanLaplacian * proteinDensity.raw());
+  if (parameters.dirichlet.eta != 0) {
+    forces.diffusionPotential.raw().noalias() =
+        vpg->cotanLaplacian * proteinDensity.raw();
+    forces.diffusionPotential.raw().array() *=
+        -parameters.dirichlet.eta * forces.proteinMask.raw().array();
+  } else {
+    forces.diffusionPotential.raw().setZero();
+  }
 
   if (parameters.proteinDistribution.lambdaPhi != 0)
-    forces.interiorPenaltyPotential.raw() =
-        forces.maskProtein(parameters.proteinDistribution.lambdaPhi *
-                           (1 / proteinDensity.raw().array() -
-                            1 / (1 - proteinDensity.raw().array())));
+    forces.interiorPenaltyPotential.raw().array() =
+        parameters.proteinDistribution.lambdaPhi *
+        (1 / proteinDensity.raw().array() -
+         1 / (1 - proteinDensity.raw().array())) *
+        forces.proteinMask.raw().array();
+  else
+    forces.interiorPenaltyPotential.raw().setZero();
   // F.chemicalPotential.raw().array() =
   //     -vpg->vertexDualAreas.raw().array() *
   //     (P.adsorption.epsilon - 2 * Kb.raw().array() * meanCurvDiff *
@@ -604,46 +837,49 @@ void System::computeChemicalPotentials() {
 void System::computeDPDForces(double dt) {
   toMatrix(forces.dampingForceVec).setZero();
   toMatrix(forces.stochasticForceVec).setZero();
-  // std::default_random_engine random_generator;
-  // gcs::EdgeData<double> random_var(mesh);
   double sigma = sqrt(2 * parameters.dpd.gamma * mem3dg::constants::kBoltzmann *
                       parameters.temperature / dt);
-  std::normal_distribution<double> normal_dist(0, sigma);
-
-  for (gcs::Edge e : mesh->edges()) {
-    gcs::Halfedge he = e.halfedge();
-    gcs::Vertex v1 = he.vertex();
-    gcs::Vertex v2 = he.next().vertex();
-
-    gc::Vector3 dVel12 = velocity[v1] - velocity[v2];
-    gc::Vector3 direction =
-        (vpg->inputVertexPositions[v1] - vpg->inputVertexPositions[v2])
-            .normalize();
-    // gc::Vector3 direction =
-    //     (vpg->vertexNormals[v1] + vpg->vertexNormals[v2]).normalize();
-
-    gc::Vector3 df =
-        parameters.dpd.gamma * (gc::dot(dVel12, direction) * direction);
-    forces.dampingForceVec[v1] -= df;
-    forces.dampingForceVec[v2] += df;
-
-    if (sigma != 0) {
-      double noise = normal_dist(rng);
-      forces.stochasticForceVec[v1] += noise * direction;
-      forces.stochasticForceVec[v2] -= noise * direction;
-    }
 
-    // gc::Vector3 dVel21 = vel[v2] - vel[v1];
-    // gc::Vector3 dPos21_n = (pos[v2] - pos[v1]).normalize();
+  // the noise on an edge only depends on (seed, step, edge index), hence is
+  // independent of the number of threads
+  if (sigma != 0) {
+    dpdNoise.resize(mesh->nEdges());
+    Philox4x32::fillNormal(seed, dpdStep++, dpdNoise);
+  }
 
-    // std::cout << -gamma * (gc::dot(dVel12, dPos12_n) * dPos12_n)
-    //           << " == " << -gamma * (gc::dot(-dVel12, -dPos12_n) *
-    //           -dPos12_n)
-    //           << " == " << -gamma * (gc::dot(dVel21, dPos21_n) * dPos21_n)
-    //           << std::endl;
+  // edges of the same color share no vertex, so the scatter is race free
+  updateEdgeColoring();
+  for (std::size_t color = 0; color + 1 < edgeColorStart.size(); ++color) {
+    const std::ptrdiff_t begin = edgeColorStart[color];
+    const std::ptrdiff_t end = edgeColorStart[color + 1];
+#ifdef MEM3DG_WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+    for (std::ptrdiff_t k = begin; k < end; ++k) {
+      gcs::Edge e = mesh->edge(coloredEdges[k]);
+      gcs::Halfedge he = e.halfedge();
+      gcs::Vertex v1 = he.vertex();
+      gcs::Vertex v2 = he.next().vertex();
+
+      gc::Vector3 dVel12 = velocity[v1] - velocity[v2];
+      gc::Vector3 direction =
+          (vpg->inputVertexPositions[v1] - vpg->inputVertexPositions[v2])
+              .normalize();
+
+      gc::Vector3 df =
+          parameters.dpd.gamma * (gc::dot(dVel12, direction) * direction);
+      forces.dampingForceVec[v1] -= df;
+      forces.dampingForceVec[v2] += df;
+
+      if (sigma != 0) {
+        double noise = sigma * dpdNoise[e.getIndex()];
+        forces.stochasticForceVec[v1] += noise * direction;
+        forces.stochasticForceVec[v2] -= noise * direction;
+      }
+    }
   }
-  forces.dampingForceVec = forces.maskForce(forces.dampingForceVec);
-  forces.stochasticForceVec = forces.maskForce(forces.stochasticForceVec);
+  forces.maskForceInPlace(forces.dampingForceVec);
+  forces.maskForceInPlace(forces.stochasticForceVec);
   // dampingForce_e =
   //     forces.maskForce(forces.addNormal(forces.ontoNormal(dampingForce_e)));
   // stochasticForce_e =
@@ -714,36 +950,7 @@ gc::Vector3 System::computeGradientNorm2Gradient(
   }
 }
 
-double System::computeNorm(
-    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> &force) const {
-  // Eigen::Matrix<double, Eigen::Dynamic, 1> mask =
-  //     outlierMask(force).cast<double>();
-
-  // return rowwiseProduct(mask, force).cwiseAbs().sum() /
-  //        rowwiseProduct(mask, vpg->vertexDualAreas.raw()).sum();
-
-  // return force.lpNorm<1>();
-  return force.norm();
-}
-
-double System::computeNorm(
-    Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic> &&force) const {
-  // Eigen::Matrix<double, Eigen::Dynamic, 1> mask =
-  //     outlierMask(force).cast<double>();
-
-  // return rowwiseProduct(mask, force).cwiseAbs().sum() /
-  //        rowwiseProduct(mask, vpg->vertexDualAreas.raw()).sum();
-  // L1 Norm
-  // return force.lpNorm<1>();
-
-  return force.norm();
-}
-
-void System::computePhysicalForcing() {
-
-  // zero all forces
-  forces.mechanicalForceVec.fill({0, 0, 0});
-
+void System::zeroForceComponents() {
   forces.bendingForceVec.fill({0, 0, 0});
   forces.bendingForceVec_areaGrad.fill({0, 0, 0});
   forces.bendingForceVec_gaussVec.fill({0, 0, 0});
@@ -781,32 +988,47 @@ void System::computePhysicalForcing() {
   forces.adsorptionPotential.raw().setZero();
   forces.aggregationPotential.raw().setZero();
   forces.interiorPenaltyPotential.raw().setZero();
+}
+
+void System::computePhysicalForcing() {
+  // terms may have been switched on since the last refresh
+  requireGeometricQuantities(activeGeometricQuantities());
+
+  // zero all forces, in lean diagnostics the component buffers are left
+  // untouched
+  if (forces.isFullDiagnostics)
+    zeroForceComponents();
 
   if (parameters.variation.isShapeVariation) {
+    // the kernel fills every row of mechanicalForceVec with its own terms
     computeMechanicalForces();
     if (parameters.external.Kf != 0) {
       prescribeExternalForce();
+      toMatrix(forces.mechanicalForceVec) += toMatrix(forces.externalForceVec);
     }
     if (parameters.selfAvoidance.mu != 0) {
       computeSelfAvoidanceForce();
+      toMatrix(forces.mechanicalForceVec) +=
+          toMatrix(forces.selfAvoidanceForceVec);
     }
-    forces.mechanicalForceVec =
-        forces.osmoticForceVec + forces.capillaryForceVec +
-        forces.bendingForceVec + forces.deviatoricForceVec +
-        forces.lineCapillaryForceVec + forces.adsorptionForceVec +
-        forces.aggregationForceVec + forces.externalForceVec +
-        forces.selfAvoidanceForceVec;
     if (parameters.damping != 0)
-      forces.mechanicalForceVec += computeDampingForce();
-    forces.mechanicalForce = forces.ontoNormal(forces.mechanicalForceVec);
+      toMatrix(forces.mechanicalForceVec) -=
+          parameters.damping * toMatrix(velocity);
+    forces.ontoNormal(forces.mechanicalForceVec, forces.mechanicalForce);
+  } else {
+    forces.mechanicalForceVec.fill({0, 0, 0});
+    forces.mechanicalForce.raw().setZero();
   }
 
   if (parameters.variation.isProteinVariation) {
     computeChemicalPotentials();
-    forces.chemicalPotential =
-        forces.adsorptionPotential + forces.aggregationPotential +
-        forces.bendingPotential + forces.deviatoricPotential +
-        forces.diffusionPotential + forces.interiorPenaltyPotential;
+    forces.chemicalPotential.raw() =
+        forces.adsorptionPotential.raw() + forces.aggregationPotential.raw() +
+        forces.bendingPotential.raw() + forces.deviatoricPotential.raw() +
+        forces.diffusionPotential.raw() +
+        forces.interiorPenaltyPotential.raw();
+  } else {
+    forces.chemicalPotential.raw().setZero();
   }
 
   // compute the mechanical error norm
@@ -820,12 +1042,19 @@ void System::computePhysicalForcing() {
                       : 0;
 }
 
+void System::computeForceComponents() {
+  bool isFullDiagnostics = forces.isFullDiagnostics;
+  forces.isFullDiagnostics = true;
+  computePhysicalForcing();
+  forces.isFullDiagnostics = isFullDiagnostics;
+}
+
 void System::computePhysicalForcing(double timeStep) {
   computePhysicalForcing();
   if (parameters.variation.isShapeVariation && parameters.dpd.gamma != 0) {
     computeDPDForces(timeStep);
-    forces.mechanicalForceVec +=
-        forces.dampingForceVec + forces.stochasticForceVec;
+    toMatrix(forces.mechanicalForceVec) +=
+        toMatrix(forces.dampingForceVec) + toMatrix(forces.stochasticForceVec);
   }
 
   // if (!f.mesh->hasBoundary()) {
@@ -0,0 +1,276 @@
+// Membrane Dynamics in 3D using Discrete Differential Geometry (Mem3DG)
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Copyright (c) 2020:
+//     Laboratory for Computational Cellular Mechanobiology
+//     Cuncheng Zhu (cuzhu@eng.ucsd.edu)
+//     Christopher T. Lee (ctlee@ucsd.edu)
+//     Ravi Ramamoorthi (ravir@cs.ucsd.edu)
+//     Padmini Rangamani (prangamani@eng.ucsd.edu)
+//
+
+#include <algorithm>
+#include <cmath>
+
+#include "mem3dg/constants.h"
+#include "mem3dg/macros.h"
+#include "mem3dg/meshops.h"
+#include "mem3dg/solver/geometry_kernel.h"
+
+namespace mem3dg {
+namespace solver {
+
+namespace gc = ::geometrycentral;
+
+namespace {
+/// overwrite the values of a diagonal sparse matrix, keeping its pattern
+template <typename Function>
+void setDiagonalValues(Eigen::SparseMatrix<double> &matrix, Function value) {
+  for (Eigen::Index k = 0; k < matrix.outerSize(); ++k) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(matrix, k); it; ++it) {
+      it.valueRef() = value(it.row());
+    }
+  }
+}
+} // namespace
+
+void GeometryKernel::build(gcs::ManifoldSurfaceMesh &mesh) {
+  const std::size_t nFaces = mesh.nFaces();
+  const std::size_t nEdges = mesh.nEdges();
+  const std::size_t nVertices = mesh.nVertices();
+
+  faceVertices.resize(nFaces, 3);
+  faceHalfedges.resize(nFaces, 3);
+  faceCorners.resize(nFaces, 3);
+  for (std::size_t i = 0; i < nFaces; ++i) {
+    gcs::Halfedge he = mesh.face(i).halfedge();
+    for (std::size_t k = 0; k < 3; ++k) {
+      faceVertices(i, k) = he.tailVertex().getIndex();
+      faceHalfedges(i, k) = he.getIndex();
+      faceCorners(i, k) = he.corner().getIndex();
+      he = he.next();
+    }
+  }
+  faceVolumes.resize(nFaces);
+  edgeCotanWeights.resize(mesh.nEdges());
+  isLaplacianOffsetsBuilt = false;
+
+  edgeVertices.resize(nEdges, 2);
+  edgeFaces.resize(nEdges, 2);
+  edgeHalfedges.resize(nEdges, 2);
+  isBoundaryEdge.resize(nEdges);
+  for (std::size_t i = 0; i < nEdges; ++i) {
+    gcs::Edge e = mesh.edge(i);
+    gcs::Halfedge he = e.halfedge();
+    edgeVertices(i, 0) = he.tailVertex().getIndex();
+    edgeVertices(i, 1) = he.tipVertex().getIndex();
+    edgeHalfedges(i, 0) = he.getIndex();
+    edgeHalfedges(i, 1) = he.twin().getIndex();
+    isBoundaryEdge[i] = e.isBoundary();
+    edgeFaces(i, 0) = he.face().getIndex();
+    edgeFaces(i, 1) = isBoundaryEdge[i] ? 0 : he.twin().face().getIndex();
+  }
+
+  exteriorHalfedges.clear();
+  for (gcs::Halfedge he : mesh.halfedges()) {
+    if (!he.isInterior())
+      exteriorHalfedges.push_back(he.getIndex());
+  }
+
+  isBoundaryVertex.resize(nVertices);
+  vertexCornerStart.assign(1, 0);
+  vertexCorners.clear();
+  vertexCornerFaces.clear();
+  vertexEdgeStart.assign(1, 0);
+  vertexEdges.clear();
+  for (std::size_t i = 0; i < nVertices; ++i) {
+    gcs::Vertex v = mesh.vertex(i);
+    isBoundaryVertex[i] = v.isBoundary();
+    for (gcs::Corner c : v.adjacentCorners()) {
+      vertexCorners.push_back(c.getIndex());
+      vertexCornerFaces.push_back(c.face().getIndex());
+    }
+    vertexCornerStart.push_back(vertexCorners.size());
+    for (gcs::Halfedge he : v.outgoingHalfedges()) {
+      vertexEdges.push_back(he.edge().getIndex());
+    }
+    vertexEdgeStart.push_back(vertexEdges.size());
+  }
+}
+
+void GeometryKernel::buildLaplacianOffsets(
+    const Eigen::SparseMatrix<double> &laplacian) {
+  if (!laplacian.isCompressed()) {
+    mem3dg_runtime_error("Cotan Laplacian is expected to be compressed!");
+  }
+  auto offset = [&laplacian](std::size_t row, std::size_t col) {
+    const int *inner = laplacian.innerIndexPtr();
+    const int *begin = inner + laplacian.outerIndexPtr()[col];
+    const int *end = inner + laplacian.outerIndexPtr()[col + 1];
+    const int *found = std::lower_bound(begin, end, int(row));
+    if (found == end || std::size_t(*found) != row) {
+      mem3dg_runtime_error("Sparsity pattern of the cotan Laplacian does not "
+                           "match the mesh!");
+    }
+    return std::ptrdiff_t(found - inner);
+  };
+  laplacianEdgeOffsets.resize(edgeVertices.rows(), 2);
+  for (Eigen::Index i = 0; i < edgeVertices.rows(); ++i) {
+    laplacianEdgeOffsets(i, 0) = offset(edgeVertices(i, 0), edgeVertices(i, 1));
+    laplacianEdgeOffsets(i, 1) = offset(edgeVertices(i, 1), edgeVertices(i, 0));
+  }
+  laplacianDiagonalOffsets.resize(isBoundaryVertex.size());
+  for (std::size_t i = 0; i < isBoundaryVertex.size(); ++i) {
+    laplacianDiagonalOffsets[i] = offset(i, i);
+  }
+  isLaplacianOffsetsBuilt = true;
+}
+
+bool GeometryKernel::isBuiltFor(gcs::ManifoldSurfaceMesh &mesh) const {
+  return std::size_t(faceVertices.rows()) == mesh.nFaces() &&
+         std::size_t(edgeVertices.rows()) == mesh.nEdges() &&
+         isBoundaryVertex.size() == mesh.nVertices();
+}
+
+double GeometryKernel::compute(gcs::VertexPositionGeometry &vpg,
+                               unsigned quantities) {
+  const bool isGaussianCurvature =
+      quantities & GeometricQuantity::GaussianCurvatures;
+  const bool isLaplacian = quantities & GeometricQuantity::CotanLaplacian;
+  const bool isDEC = quantities & GeometricQuantity::DECOperators;
+  if (isLaplacian && !isLaplacianOffsetsBuilt) {
+    buildLaplacianOffsets(vpg.cotanLaplacian);
+  }
+  double *laplacian = isLaplacian ? vpg.cotanLaplacian.valuePtr() : nullptr;
+
+  const auto &position = vpg.inputVertexPositions.raw();
+  auto &faceNormal = vpg.faceNormals.raw();
+  auto &faceArea = vpg.faceAreas.raw();
+  auto &cornerAngle = vpg.cornerAngles.raw();
+  auto &halfedgeCotanWeight = vpg.halfedgeCotanWeights.raw();
+  auto &edgeLength = vpg.edgeLengths.raw();
+  auto &edgeDihedralAngle = vpg.edgeDihedralAngles.raw();
+  auto &vertexDualArea = vpg.vertexDualAreas.raw();
+  auto &vertexNormal = vpg.vertexNormals.raw();
+  auto &vertexMeanCurvature = vpg.vertexMeanCurvatures.raw();
+  auto &vertexGaussianCurvature = vpg.vertexGaussianCurvatures.raw();
+
+  // face sweep, every face only writes to its own entries
+  const std::ptrdiff_t nFaces = faceVertices.rows();
+#ifdef MEM3DG_WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (std::ptrdiff_t i = 0; i < nFaces; ++i) {
+    gc::Vector3 p[3] = {position[faceVertices(i, 0)],
+                        position[faceVertices(i, 1)],
+                        position[faceVertices(i, 2)]};
+    gc::Vector3 normal = gc::cross(p[1] - p[0], p[2] - p[0]);
+    double doubleArea = gc::norm(normal);
+    faceNormal[i] = normal / doubleArea;
+    faceArea[i] = 0.5 * doubleArea;
+    for (std::size_t k = 0; k < 3; ++k) {
+      const gc::Vector3 &pA = p[k];
+      const gc::Vector3 &pB = p[(k + 1) % 3];
+      const gc::Vector3 &pC = p[(k + 2) % 3];
+      double cosine = gc::dot(gc::unit(pB - pA), gc::unit(pC - pA));
+      cornerAngle[faceCorners(i, k)] =
+          std::acos(std::max(-1.0, std::min(1.0, cosine)));
+      // the angle opposite to the k-th halfedge is at the (k + 2)-th vertex
+      halfedgeCotanWeight[faceHalfedges(i, k)] =
+          0.5 * gc::dot(pA - pC, pB - pC) / doubleArea;
+    }
+    faceVolumes[i] = signedVolumeFromFace(p[0], p[1], p[2]);
+  }
+  for (std::size_t he : exteriorHalfedges) {
+    halfedgeCotanWeight[he] = 0;
+  }
+
+  // edge sweep
+  const std::ptrdiff_t nEdges = edgeVertices.rows();
+#ifdef MEM3DG_WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (std::ptrdiff_t i = 0; i < nEdges; ++i) {
+    gc::Vector3 vec =
+        position[edgeVertices(i, 1)] - position[edgeVertices(i, 0)];
+    edgeLength[i] = gc::norm(vec);
+    // exterior halfedges have zero weight
+    edgeCotanWeights[i] = halfedgeCotanWeight[edgeHalfedges(i, 0)] +
+                          halfedgeCotanWeight[edgeHalfedges(i, 1)];
+    if (isBoundaryEdge[i]) {
+      edgeDihedralAngle[i] = 0;
+    } else {
+      const gc::Vector3 &n1 = faceNormal[edgeFaces(i, 0)];
+      const gc::Vector3 &n2 = faceNormal[edgeFaces(i, 1)];
+      edgeDihedralAngle[i] = std::atan2(gc::dot(vec / edgeLength[i],
+                                                gc::cross(n1, n2)),
+                                        gc::dot(n1, n2));
+    }
+    if (isLaplacian) {
+      laplacian[laplacianEdgeOffsets(i, 0)] = -edgeCotanWeights[i];
+      laplacian[laplacianEdgeOffsets(i, 1)] = -edgeCotanWeights[i];
+    }
+  }
+
+  // vertex sweep, gather from the adjacent corners and edges
+  const std::ptrdiff_t nVertices = isBoundaryVertex.size();
+#ifdef MEM3DG_WITH_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+  for (std::ptrdiff_t i = 0; i < nVertices; ++i) {
+    double area = 0, angleSum = 0;
+    gc::Vector3 normal{0, 0, 0};
+    for (std::size_t k = vertexCornerStart[i]; k < vertexCornerStart[i + 1];
+         ++k) {
+      const double angle = cornerAngle[vertexCorners[k]];
+      area += faceArea[vertexCornerFaces[k]];
+      angleSum += angle;
+      normal += angle * faceNormal[vertexCornerFaces[k]];
+    }
+    vertexDualArea[i] = area / 3;
+    vertexNormal[i] = gc::unit(normal);
+    if (isGaussianCurvature) {
+      vertexGaussianCurvature[i] =
+          (isBoundaryVertex[i] ? constants::PI : 2 * constants::PI) - angleSum;
+    }
+
+    double meanCurvature = 0, cotanWeight = 0;
+    for (std::size_t k = vertexEdgeStart[i]; k < vertexEdgeStart[i + 1]; ++k) {
+      meanCurvature +=
+          edgeDihedralAngle[vertexEdges[k]] * edgeLength[vertexEdges[k]];
+      cotanWeight += edgeCotanWeights[vertexEdges[k]];
+    }
+    vertexMeanCurvature[i] = meanCurvature / 4;
+    if (isLaplacian) {
+      laplacian[laplacianDiagonalOffsets[i]] = cotanWeight;
+    }
+  }
+
+  // diagonal operators
+  if (quantities & GeometricQuantity::LumpedMassMatrix) {
+    setDiagonalValues(vpg.vertexLumpedMassMatrix,
+                      [&](Eigen::Index i) { return vertexDualArea[i]; });
+  }
+  if (isDEC) {
+    setDiagonalValues(vpg.hodge0,
+                      [&](Eigen::Index i) { return vertexDualArea[i]; });
+    setDiagonalValues(vpg.hodge0Inverse,
+                      [&](Eigen::Index i) { return 1 / vertexDualArea[i]; });
+    setDiagonalValues(vpg.hodge1,
+                      [&](Eigen::Index i) { return edgeCotanWeights[i]; });
+    setDiagonalValues(vpg.hodge1Inverse,
+                      [&](Eigen::Index i) { return 1 / edgeCotanWeights[i]; });
+    setDiagonalValues(vpg.hodge2,
+                      [&](Eigen::Index i) { return 1 / faceArea[i]; });
+    setDiagonalValues(vpg.hodge2Inverse,
+                      [&](Eigen::Index i) { return faceArea[i]; });
+  }
+
+  return faceVolumes.sum();
+}
+
+} // namespace solver
+} // namespace mem3dg
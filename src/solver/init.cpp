@@ -20,6 +20,7 @@
 #include "mem3dg/constants.h"
 #include "mem3dg/meshops.h"
 #include "mem3dg/solver/mutable_trajfile.h"
+#include <algorithm>
 #include <cmath>
 #include <stdexcept>
 #include <vector>
@@ -203,8 +204,10 @@ void System::saveRichData(std::string PathToSave, bool isJustGeometry) {
                         vpg->vertexDualAreas.raw().array());
     richData.addVertexProperty("mean_curvature", meanCurv);
     gcs::VertexData<double> gaussCurv(*mesh);
+    vpg->requireVertexGaussianCurvatures();
     gaussCurv.fromVector(vpg->vertexGaussianCurvatures.raw().array() /
                          vpg->vertexDualAreas.raw().array());
+    vpg->unrequireVertexGaussianCurvatures();
     richData.addVertexProperty("gauss_curvature", gaussCurv);
     richData.addVertexProperty("spon_curvature", H0);
 
@@ -262,23 +265,17 @@ void System::checkConfiguration() {
         "lead to ambiguity! Please check by visualizing it first!");
   }
   if (parameters.selfAvoidance.mu != 0) {
-    for (std::size_t i = 0; i < mesh->nVertices(); ++i) {
-      gc::Vertex vi{mesh->vertex(i)};
-      gc::VertexData<bool> neighborList(*mesh, false);
-      meshProcessor.meshMutator.markVertices(neighborList, vi,
-                                             parameters.selfAvoidance.n);
-      for (std::size_t j = i + 1; j < mesh->nVertices(); ++j) {
-        if (neighborList[j])
-          continue;
-        gc::Vertex vj{mesh->vertex(j)};
-        gc::Vector3 r =
-            vpg->inputVertexPositions[vj] - vpg->inputVertexPositions[vi];
-        double distance = gc::norm(r);
-        if (distance < parameters.selfAvoidance.d)
-          mem3dg_runtime_error(
-              "Input mesh violates the self avoidance constraint!");
-      }
+    if (parameters.selfAvoidance.cutoff > 0) {
+      updateSelfAvoidancePairs();
     }
+    forEachSelfAvoidancePair([this](std::size_t i, std::size_t j) {
+      gc::Vector3 r =
+          vpg->inputVertexPositions[j] - vpg->inputVertexPositions[i];
+      double distance = gc::norm(r);
+      if (distance < parameters.selfAvoidance.d)
+        mem3dg_runtime_error(
+            "Input mesh violates the self avoidance constraint!");
+    });
   }
 }
 
@@ -305,9 +302,19 @@ void System::pcg_test() {
 }
 
 void System::initConstants() {
-  // Initialize random number generator
-  pcg_extras::seed_seq_from<std::random_device> seed_source;
-  rng = pcg32(seed_source);
+  if (parameters.dpd.seed >= 0) {
+    initConstants(parameters.dpd.seed);
+  } else {
+    std::random_device device;
+    initConstants((std::uint64_t(device()) << 32) | device());
+  }
+}
+
+void System::initConstants(std::uint64_t seed_) {
+  // Initialize random number generators
+  seed = seed_;
+  rng = pcg32(seed);
+  dpdStep = 0;
 
   // // Initialize V-E distribution matrix for line tension calculation
   // if (P.dirichlet.eta != 0) {
@@ -385,6 +392,11 @@ void System::initConstants() {
                         parameters.boundary.proteinBoundaryCondition);
   }
 
+  // update self-avoidance neighbor pairs
+  if (parameters.selfAvoidance.mu != 0 && parameters.selfAvoidance.cutoff > 0) {
+    updateSelfAvoidancePairs();
+  }
+
   // initialize/update total surface area
   surfaceArea = vpg->faceAreas.raw().sum() + parameters.tension.A_res;
   std::cout << "area_init = " << surfaceArea << std::endl;
@@ -402,10 +414,81 @@ void System::initConstants() {
   std::cout << "vol_init = " << volume << std::endl;
 }
 
+unsigned System::activeGeometricQuantities() const {
+  unsigned quantities = extraGeometricQuantities;
+  if (parameters.bending.Kd != 0 || parameters.bending.Kdc != 0 ||
+      parameters.external.Kf != 0)
+    quantities |= GeometricQuantity::GaussianCurvatures;
+  if (parameters.dirichlet.eta != 0)
+    quantities |= GeometricQuantity::CotanLaplacian;
+  return quantities;
+}
+
+void System::requireGeometricQuantities(unsigned quantities) {
+  const unsigned added = quantities & ~requiredGeometricQuantities;
+  const unsigned removed = requiredGeometricQuantities & ~quantities;
+  if (added & GeometricQuantity::GaussianCurvatures)
+    vpg->requireVertexGaussianCurvatures();
+  if (added & GeometricQuantity::CotanLaplacian)
+    vpg->requireCotanLaplacian();
+  if (added & GeometricQuantity::LumpedMassMatrix)
+    vpg->requireVertexLumpedMassMatrix();
+  if (added & GeometricQuantity::DECOperators)
+    vpg->requireDECOperators();
+  if (removed & GeometricQuantity::GaussianCurvatures)
+    vpg->unrequireVertexGaussianCurvatures();
+  if (removed & GeometricQuantity::CotanLaplacian)
+    vpg->unrequireCotanLaplacian();
+  if (removed & GeometricQuantity::LumpedMassMatrix)
+    vpg->unrequireVertexLumpedMassMatrix();
+  if (removed & GeometricQuantity::DECOperators)
+    vpg->unrequireDECOperators();
+  requiredGeometricQuantities = quantities;
+}
+
+void System::refreshGeometry() {
+  requireGeometricQuantities(activeGeometricQuantities());
+  if (isFusedGeometry && !isGeometryKernelOutdated &&
+      geometryKernel.isBuiltFor(*mesh)) {
+    double faceVolume =
+        geometryKernel.compute(*vpg, requiredGeometricQuantities);
+    // quantities not written by the kernel are stale, release them so that
+    // they are recomputed when required
+    vpg->purgeQuantities();
+    meshVolume =
+        faceVolume + (mesh->hasBoundary() ? getHoleVolume(*mesh, *vpg) : 0);
+  } else {
+    // the kernel writes to buffers allocated by geometry-central, so it is
+    // only built after a full refresh
+    vpg->refreshQuantities();
+    meshVolume = getMeshVolume(*mesh, *vpg, true);
+    if (isFusedGeometry &&
+        (isGeometryKernelOutdated || !geometryKernel.isBuiltFor(*mesh))) {
+      geometryKernel.build(*mesh);
+      isGeometryKernelOutdated = false;
+    }
+  }
+  volume = meshVolume + parameters.osmotic.V_res;
+  refreshedPositions = toMatrix(vpg->inputVertexPositions);
+}
+
+bool System::isGeometryRefreshed() const {
+  return std::size_t(refreshedPositions.rows()) == mesh->nVertices() &&
+         refreshedPositions == toMatrix(vpg->inputVertexPositions);
+}
+
 void System::updateConfigurations(bool isUpdateGeodesics) {
 
-  // refresh cached quantities after regularization
-  vpg->refreshQuantities();
+  // refresh cached quantities and volume after regularization, only the ones
+  // read by the active terms are recomputed. Geometry is reused when positions
+  // are unchanged, e.g. protein-only variation and chemical line search
+  const bool isGeometryFrozen = !isUpdateGeodesics && isGeometryRefreshed();
+  if (isGeometryFrozen) {
+    requireGeometricQuantities(activeGeometricQuantities());
+    volume = meshVolume + parameters.osmotic.V_res;
+  } else {
+    refreshGeometry();
+  }
 
   // recompute floating "the vertex"
   if (parameters.point.isFloatVertex && isUpdateGeodesics) {
@@ -480,9 +563,6 @@ void System::updateConfigurations(bool isUpdateGeodesics) {
     mem3dg_runtime_error("updateVertexPosition: P.relation is invalid option!");
   }
 
-  /// initialize/update enclosed volume
-  volume = getMeshVolume(*mesh, *vpg, true) + parameters.osmotic.V_res;
-
   // update global osmotic pressure
   if (parameters.osmotic.isPreferredVolume) {
     forces.osmoticPressure =
@@ -497,6 +577,17 @@ void System::updateConfigurations(bool isUpdateGeodesics) {
         (parameters.osmotic.n / volume - parameters.osmotic.cam);
   }
 
+  // update self-avoidance neighbor pairs, unless positions and search
+  // parameters are unchanged
+  const bool isPairsUpToDate =
+      isGeometryFrozen &&
+      cellList.cutoff == parameters.selfAvoidance.cutoff &&
+      selfAvoidanceExclusionLayer == parameters.selfAvoidance.n;
+  if (parameters.selfAvoidance.mu != 0 && parameters.selfAvoidance.cutoff > 0 &&
+      !isPairsUpToDate) {
+    updateSelfAvoidancePairs();
+  }
+
   // initialize/update total surface area
   surfaceArea = vpg->faceAreas.raw().sum() + parameters.tension.A_res;
 
@@ -524,6 +615,99 @@ void System::updateConfigurations(bool isUpdateGeodesics) {
   }
 }
 
+void System::updateSelfAvoidanceExclusions() {
+  const std::size_t layer = parameters.selfAvoidance.n;
+  if (!isSelfAvoidanceExclusionOutdated &&
+      selfAvoidanceExclusionLayer == layer &&
+      selfAvoidanceExclusionStart.size() == mesh->nVertices() + 1)
+    return;
+  if (layer > 2)
+    mem3dg_runtime_error("max layer number is 2!");
+
+  // collect the neighborhood j > i of every vertex i as a row of the table
+  selfAvoidanceExclusionStart.assign(1, 0);
+  selfAvoidanceExclusionStart.reserve(mesh->nVertices() + 1);
+  selfAvoidanceExclusions.clear();
+  gc::VertexData<bool> isVisited(*mesh, false);
+  std::vector<std::size_t> ring;
+  auto visit = [&](gc::Vertex v) {
+    if (!isVisited[v]) {
+      isVisited[v] = true;
+      ring.push_back(v.getIndex());
+    }
+  };
+  for (std::size_t i = 0; i < mesh->nVertices(); ++i) {
+    gc::Vertex vi{mesh->vertex(i)};
+    ring.clear();
+    visit(vi);
+    if (layer > 0) {
+      for (gc::Vertex nv : vi.adjacentVertices()) {
+        visit(nv);
+        if (layer > 1) {
+          for (gc::Vertex nnv : nv.adjacentVertices()) {
+            visit(nnv);
+          }
+        }
+      }
+    }
+    std::sort(ring.begin(), ring.end());
+    for (std::size_t j : ring) {
+      isVisited[j] = false;
+      if (j > i)
+        selfAvoidanceExclusions.push_back(j);
+    }
+    selfAvoidanceExclusionStart.push_back(selfAvoidanceExclusions.size());
+  }
+
+  selfAvoidanceExclusionLayer = layer;
+  isSelfAvoidanceExclusionOutdated = false;
+  isSelfAvoidanceFieldOutdated = true;
+}
+
+void System::updateSelfAvoidancePairs() {
+  updateSelfAvoidanceExclusions();
+  cellList.build(toMatrix(vpg->inputVertexPositions),
+                 parameters.selfAvoidance.cutoff);
+  cellList.findPairs(selfAvoidancePairs);
+
+  // remove excluded pairs, exclusion rows are sorted
+  std::size_t nKept = 0;
+  for (std::size_t k = 0; k < selfAvoidancePairs.size(); ++k) {
+    std::size_t i = selfAvoidancePairs[k].first;
+    std::size_t j = selfAvoidancePairs[k].second;
+    if (!std::binary_search(
+            selfAvoidanceExclusions.begin() + selfAvoidanceExclusionStart[i],
+            selfAvoidanceExclusions.begin() +
+                selfAvoidanceExclusionStart[i + 1],
+            j))
+      selfAvoidancePairs[nKept++] = selfAvoidancePairs[k];
+  }
+  selfAvoidancePairs.resize(nKept);
+}
+
+void System::forEachSelfAvoidancePair(
+    const std::function<void(std::size_t, std::size_t)> &pairFunction) {
+  if (parameters.selfAvoidance.cutoff > 0) {
+    for (const auto &pair : selfAvoidancePairs) {
+      pairFunction(pair.first, pair.second);
+    }
+  } else {
+    updateSelfAvoidanceExclusions();
+    for (std::size_t i = 0; i < mesh->nVertices(); ++i) {
+      // walk the sorted exclusion row along with j
+      std::size_t k = selfAvoidanceExclusionStart[i];
+      const std::size_t kEnd = selfAvoidanceExclusionStart[i + 1];
+      for (std::size_t j = i + 1; j < mesh->nVertices(); ++j) {
+        if (k < kEnd && selfAvoidanceExclusions[k] == j) {
+          ++k;
+          continue;
+        }
+        pairFunction(i, j);
+      }
+    }
+  }
+}
+
 double System::inferTargetSurfaceArea() {
   double targetArea;
   if (isOpenMesh) {
@@ -13,8 +13,10 @@
 //
 
 #include <Eigen/Core>
+#include <deque>
 #include <iostream>
 #include <math.h>
+#include <vector>
 #include <pcg_random.hpp>
 
 #include <geometrycentral/surface/halfedge_mesh.h>
@@ -36,7 +38,10 @@ namespace gc = ::geometrycentral;
 
 bool BFGS::integrate() {
 
-  signal(SIGINT, signalHandler);
+  interruptSignal() = 0;
+  // the previous handler is restored on return
+  ScopedSignalHandler sigintHandler(
+      SIGINT, isSyncOnInterrupt ? interruptHandler : signalHandler);
 
 #ifdef __linux__
   // start the timer
@@ -68,15 +73,38 @@ bool BFGS::integrate() {
       saveData();
     }
 
+    // Process mesh every tProcessMesh period
+    if (system.time - lastProcessMesh > processMeshPeriod) {
+      lastProcessMesh = system.time;
+      system.mutateMesh();
+      system.updateConfigurations(false);
+    }
+
+    // update geodesics every tUpdateGeodesics period
+    if (system.time - lastUpdateGeodesics > updateGeodesicsPeriod) {
+      lastUpdateGeodesics = system.time;
+      system.updateConfigurations(true);
+    }
+
     // break loop if EXIT flag is on
     if (EXIT) {
       break;
     }
 
-    // step forward
-    march();
+    // step forward, curvature pairs are invalid across mesh processing
+    if (system.time == lastProcessMesh || system.time == lastUpdateGeodesics) {
+      system.time += 1e-10 * characteristicTimeStep;
+      resetHistory();
+    } else {
+      march();
+    }
   }
 
+  // write the queued frames and release the file before it is renamed
+#ifdef MEM3DG_WITH_NETCDF
+  trajectoryWriter.stop();
+#endif
+
   // return if optimization is sucessful
   if (!SUCCESS) {
     if (tolerance == 0) {
@@ -102,12 +130,8 @@ void BFGS::checkParameters() {
   if (system.parameters.dpd.gamma != 0) {
     mem3dg_runtime_error("DPD has to be turned off for BFGS integration!");
   }
-  // if (f.O.isVertexShift) {
-  //   mem3dg_runtime_error(
-  //       "Vertex shift is not supported for BFGS integration!");
-  // }
-  if (!isBacktrack) {
-    mem3dg_runtime_error("Backtracking is required for BFGS integration");
+  if (historyLength < 1) {
+    mem3dg_runtime_error("historyLength > 0!");
   }
   if (system.parameters.proteinMobility != 1 &&
       system.parameters.proteinMobility != 0) {
@@ -129,38 +153,9 @@ void BFGS::checkParameters() {
 }
 
 void BFGS::status() {
-  auto physicalForceVec = toMatrix(system.forces.mechanicalForceVec);
-  auto physicalForce = toMatrix(system.forces.mechanicalForce);
-
   // compute summerized forces
   system.computePhysicalForcing(timeStep);
 
-  // update
-  if (system.time != initialTime || ifRestart) {
-    EigenVectorX1d y = -flatten(physicalForceVec) + pastPhysicalForce;
-    double sTy = (s.transpose() * y);
-    hess_inv +=
-        (s * s.transpose()) * (sTy + y.transpose() * hess_inv * y) / sTy / sTy -
-        (hess_inv * y * s.transpose() + s * y.transpose() * hess_inv) / sTy;
-
-    EigenVectorX1d y_protein =
-        -system.forces.chemicalPotential.raw() + pastPhysicalForce_protein;
-    double sTy_protein = (s_protein.transpose() * y_protein);
-    hess_inv_protein += (s_protein * s_protein.transpose()) *
-                            (sTy_protein + y_protein.transpose() *
-                                               hess_inv_protein * y_protein) /
-                            sTy_protein / sTy_protein -
-                        (hess_inv_protein * y_protein * s_protein.transpose() +
-                         s_protein * y_protein.transpose() * hess_inv_protein) /
-                            sTy_protein;
-  }
-  pastPhysicalForce = flatten(physicalForceVec);
-  pastPhysicalForce_protein = system.forces.chemicalPotential.raw();
-  // std::cout << "if equal: "
-  //           << (unflatten<3>(flatten(physicalForceVec)).array() ==
-  //               physicalForceVec.array())
-  //           << std::endl;
-
   // compute the area contraint error
   areaDifference =
       (system.parameters.tension.Ksg != 0)
@@ -175,7 +170,7 @@ void BFGS::status() {
             : 0.0;
     // thresholding, exit if fulfilled and iterate if not
     reducedVolumeThreshold(EXIT, isAugmentedLagrangian, areaDifference,
-                           volumeDifference, ctol, 1.3);
+                           volumeDifference, constraintTolerance, 1.3);
   } else {
     // compute pressure constraint error
     volumeDifference = (!system.mesh->hasBoundary())
@@ -185,7 +180,7 @@ void BFGS::status() {
                            : 1.0;
     // thresholding, exit if fulfilled and iterate if not
     pressureConstraintThreshold(EXIT, isAugmentedLagrangian, areaDifference,
-                                ctol, 1.3);
+                                constraintTolerance, 1.3);
   }
 
   // exit if reached time
@@ -195,6 +190,13 @@ void BFGS::status() {
     SUCCESS = false;
   }
 
+  // exit if interrupted, saving the last frame
+  if (interruptSignal() != 0) {
+    std::cout << "\nInterrupted." << std::endl;
+    EXIT = true;
+    SUCCESS = false;
+  }
+
   // compute the free energy of the system
   system.computeTotalEnergy();
 
@@ -202,52 +204,118 @@ void BFGS::status() {
   finitenessErrorBacktrace();
 }
 
+void BFGS::resetHistory() {
+  sHistory.clear();
+  yHistory.clear();
+  sHistory_protein.clear();
+  yHistory_protein.clear();
+  isHistoryPending = false;
+}
+
+void BFGS::updateHistory(std::deque<EigenVectorX1d> &sHistory_,
+                         std::deque<EigenVectorX1d> &yHistory_,
+                         const EigenVectorX1d &s_, EigenVectorX1d &&y_) {
+  // skip pairs violating the curvature condition since backtracking only
+  // enforces sufficient decrease; H stays positive definite
+  if (s_.dot(y_) <= 1e-12 * s_.norm() * y_.norm()) {
+    return;
+  }
+  if (sHistory_.size() == historyLength) {
+    sHistory_.pop_front();
+    yHistory_.pop_front();
+  }
+  sHistory_.push_back(s_);
+  yHistory_.push_back(std::move(y_));
+}
+
+void BFGS::twoLoopRecursion(const std::deque<EigenVectorX1d> &sHistory_,
+                            const std::deque<EigenVectorX1d> &yHistory_,
+                            EigenVectorX1d &q) const {
+  const std::size_t m = sHistory_.size();
+  if (m == 0) {
+    return;
+  }
+  std::vector<double> alpha(m), rhoHistory(m);
+  for (std::size_t i = m; i-- > 0;) {
+    rhoHistory[i] = 1.0 / yHistory_[i].dot(sHistory_[i]);
+    alpha[i] = rhoHistory[i] * sHistory_[i].dot(q);
+    q -= alpha[i] * yHistory_[i];
+  }
+  // initial inverse Hessian H0 = gamma * I scaled by the latest pair
+  q *= sHistory_.back().dot(yHistory_.back()) /
+       yHistory_.back().squaredNorm();
+  for (std::size_t i = 0; i < m; ++i) {
+    double beta = rhoHistory[i] * yHistory_[i].dot(q);
+    q += (alpha[i] - beta) * sHistory_[i];
+  }
+}
+
 void BFGS::march() {
-  if (system.time == lastSave && system.time != initialTime) {
-    // process the mesh with regularization or mutation
-    system.mutateMesh();
-    system.updateConfigurations(true);
-
-    system.time += 1e-10 * characteristicTimeStep;
-    ifRestart = true;
-    hess_inv.setIdentity();
-    hess_inv_protein.setIdentity();
-  } else {
-    // map the raw eigen datatype for computation
-    auto f_velocity_e = toMatrix(system.velocity);
-    auto f_forces_mechanicalForceVec_e =
-        toMatrix(system.forces.mechanicalForceVec);
-
-    f_velocity_e = unflatten<3>(
-        (hess_inv * flatten(f_forces_mechanicalForceVec_e)).eval());
-    toMatrix(system.proteinVelocity) =
-        hess_inv_protein * system.forces.chemicalPotential.raw();
-
-    // adjust time step if adopt adaptive time step based on mesh size and force
-    // magnitude
-    if (isAdaptiveStep) {
-      updateAdaptiveCharacteristicStep();
+  // map the raw eigen datatype for computation
+  auto f_velocity_e = toMatrix(system.velocity);
+  auto f_forces_mechanicalForceVec_e =
+      toMatrix(system.forces.mechanicalForceVec);
+  auto f_positions_e = toMatrix(system.vpg->inputVertexPositions);
+  const bool isShapeVariation = system.parameters.variation.isShapeVariation;
+  const bool isProteinVariation =
+      system.parameters.variation.isProteinVariation;
+
+  // the force is the negative gradient, y = g_{k+1} - g_k = f_k - f_{k+1}
+  EigenVectorX1d physicalForce = flatten(f_forces_mechanicalForceVec_e);
+  EigenVectorX1d physicalForce_protein =
+      system.parameters.proteinMobility * system.forces.chemicalPotential.raw();
+  if (isHistoryPending) {
+    if (isShapeVariation) {
+      updateHistory(sHistory, yHistory, s, pastPhysicalForce - physicalForce);
     }
+    if (isProteinVariation) {
+      updateHistory(sHistory_protein, yHistory_protein, s_protein,
+                    pastPhysicalForce_protein - physicalForce_protein);
+    }
+  }
+  pastPhysicalForce = physicalForce;
+  pastPhysicalForce_protein = physicalForce_protein;
+
+  // search direction -H * g = H * f
+  twoLoopRecursion(sHistory, yHistory, physicalForce);
+  twoLoopRecursion(sHistory_protein, yHistory_protein, physicalForce_protein);
+  f_velocity_e = unflatten<3>(physicalForce);
+  system.proteinVelocity.raw() = physicalForce_protein;
+
+  // adjust time step if adopt adaptive time step based on mesh size and force
+  // magnitude
+  if (isAdaptiveStep) {
+    updateAdaptiveCharacteristicStep();
+  }
 
-    // time stepping on vertex position
-    timeStep =
-        backtrack(f_velocity_e, toMatrix(system.proteinVelocity), rho, c1);
+  // time stepping on vertex position
+  EigenVectorX1d pastPositions = flatten(f_positions_e);
+  EigenVectorX1d pastProteinDensity = system.proteinDensity.raw();
+  if (isBacktrack) {
+    // the line search leaves the system at the accepted step
+    timeStep = backtrack(toMatrix(system.velocity),
+                         toMatrix(system.proteinVelocity), rho, c1);
+  } else {
+    timeStep = characteristicTimeStep;
     system.vpg->inputVertexPositions += system.velocity * timeStep;
     system.proteinDensity += system.proteinVelocity * timeStep;
     system.time += timeStep;
-    s = timeStep * flatten(f_velocity_e);
-    s_protein = timeStep * toMatrix(system.proteinVelocity);
-
-    // regularization
-    if (system.meshProcessor.isMeshRegularize) {
-      system.computeRegularizationForce();
-      system.vpg->inputVertexPositions.raw() +=
-          system.forces.regularizationForce.raw();
-    }
+  }
 
-    // recompute cached values
-    system.updateConfigurations(false);
+  // regularization
+  if (system.meshProcessor.isMeshRegularize) {
+    system.computeRegularizationForce();
+    system.vpg->inputVertexPositions.raw() +=
+        system.forces.regularizationForce.raw();
   }
+
+  // displacements of the step, paired with y at the next march
+  s = flatten(f_positions_e) - pastPositions;
+  s_protein = system.proteinDensity.raw() - pastProteinDensity;
+  isHistoryPending = true;
+
+  // recompute cached values
+  system.updateConfigurations(false);
 }
 } // namespace integrator
 } // namespace solver
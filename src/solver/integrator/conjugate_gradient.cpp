@@ -38,7 +38,10 @@ namespace gc = ::geometrycentral;
 
 bool ConjugateGradient::integrate() {
 
-  signal(SIGINT, signalHandler);
+  interruptSignal() = 0;
+  // the previous handler is restored on return
+  ScopedSignalHandler sigintHandler(
+      SIGINT, isSyncOnInterrupt ? interruptHandler : signalHandler);
 
 #ifdef __linux__
   // start the timer
@@ -97,6 +100,11 @@ bool ConjugateGradient::integrate() {
     }
   }
 
+  // write the queued frames and release the file before it is renamed
+#ifdef MEM3DG_WITH_NETCDF
+  trajectoryWriter.stop();
+#endif
+
   // return if optimization is sucessful
   if (!SUCCESS) {
     if (tolerance == 0) {
@@ -175,6 +183,13 @@ void ConjugateGradient::status() {
     SUCCESS = false;
   }
 
+  // exit if interrupted, saving the last frame
+  if (interruptSignal() != 0) {
+    std::cout << "\nInterrupted." << std::endl;
+    EXIT = true;
+    SUCCESS = false;
+  }
+
   // compute the free energy of the system
   system.computeTotalEnergy();
 
@@ -183,29 +198,40 @@ void ConjugateGradient::status() {
 }
 
 void ConjugateGradient::march() {
+  // (preconditioned) shape force
+  const bool isShapeVariation = system.parameters.variation.isShapeVariation;
+  EigenVectorX3dr shapeDirection =
+      (isSobolevPreconditioned && isShapeVariation)
+          ? sobolevPrecondition(toMatrix(system.forces.mechanicalForceVec))
+          : EigenVectorX3dr(toMatrix(system.forces.mechanicalForceVec));
+
   // determine conjugate gradient direction, restart after nVertices() cycles
   if (countCG % restartPeriod == 0) {
     pastNormSquared =
-        (system.parameters.variation.isShapeVariation
-             ? toMatrix(system.forces.mechanicalForceVec).squaredNorm()
+        (isShapeVariation
+             ? (toMatrix(system.forces.mechanicalForceVec).array() *
+                shapeDirection.array())
+                   .sum()
              : 0) +
         (system.parameters.variation.isProteinVariation
              ? system.forces.chemicalPotential.raw().squaredNorm()
              : 0);
-    system.velocity = system.forces.mechanicalForceVec;
+    toMatrix(system.velocity) = shapeDirection;
     system.proteinVelocity =
         system.parameters.proteinMobility * system.forces.chemicalPotential;
     countCG = 1;
   } else {
     currentNormSquared =
-        (system.parameters.variation.isShapeVariation
-             ? toMatrix(system.forces.mechanicalForceVec).squaredNorm()
+        (isShapeVariation
+             ? (toMatrix(system.forces.mechanicalForceVec).array() *
+                shapeDirection.array())
+                   .sum()
              : 0) +
         (system.parameters.variation.isProteinVariation
              ? system.forces.chemicalPotential.raw().squaredNorm()
              : 0);
     system.velocity *= currentNormSquared / pastNormSquared;
-    system.velocity += system.forces.mechanicalForceVec;
+    toMatrix(system.velocity) += shapeDirection;
     system.proteinVelocity *= currentNormSquared / pastNormSquared;
     system.proteinVelocity +=
         system.parameters.proteinMobility * system.forces.chemicalPotential;
@@ -220,14 +246,15 @@ void ConjugateGradient::march() {
 
   // time stepping on vertex position
   if (isBacktrack) {
+    // the line search leaves the system at the accepted step
     timeStep = backtrack(toMatrix(system.velocity),
                          toMatrix(system.proteinVelocity), rho, c1);
   } else {
     timeStep = characteristicTimeStep;
+    system.vpg->inputVertexPositions += system.velocity * timeStep;
+    system.proteinDensity += system.proteinVelocity * timeStep;
+    system.time += timeStep;
   }
-  system.vpg->inputVertexPositions += system.velocity * timeStep;
-  system.proteinDensity += system.proteinVelocity * timeStep;
-  system.time += timeStep;
 
   // regularization
   if (system.meshProcessor.isMeshRegularize) {
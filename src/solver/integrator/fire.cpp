@@ -0,0 +1,266 @@
+// Membrane Dynamics in 3D using Discrete Differential Geometry (Mem3DG)
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Copyright (c) 2020:
+//     Laboratory for Computational Cellular Mechanobiology
+//     Cuncheng Zhu (cuzhu@eng.ucsd.edu)
+//     Christopher T. Lee (ctlee@ucsd.edu)
+//     Ravi Ramamoorthi (ravir@cs.ucsd.edu)
+//     Padmini Rangamani (prangamani@eng.ucsd.edu)
+//
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+#include <geometrycentral/surface/halfedge_mesh.h>
+#include <geometrycentral/surface/vertex_position_geometry.h>
+#include <geometrycentral/utilities/eigen_interop_helpers.h>
+#include <geometrycentral/utilities/vector3.h>
+
+#include "mem3dg/meshops.h"
+#include "mem3dg/solver/integrator/fire.h"
+#include "mem3dg/solver/integrator/integrator.h"
+#include "mem3dg/solver/system.h"
+#include "mem3dg/type_utilities.h"
+
+namespace mem3dg {
+namespace solver {
+namespace integrator {
+namespace gc = ::geometrycentral;
+
+bool FIRE::integrate() {
+
+  interruptSignal() = 0;
+  // the previous handler is restored on return
+  ScopedSignalHandler sigintHandler(
+      SIGINT, isSyncOnInterrupt ? interruptHandler : signalHandler);
+
+#ifdef __linux__
+  // start the timer
+  struct timeval start;
+  gettimeofday(&start, NULL);
+#endif
+
+  // initialize netcdf traj file
+#ifdef MEM3DG_WITH_NETCDF
+  if (verbosity > 0) {
+    // createNetcdfFile();
+    createMutableNetcdfFile();
+    // print to console
+    std::cout << "Initialized NetCDF file at "
+              << outputDirectory + "/" + trajFileName << std::endl;
+  }
+#endif
+
+  // time integration loop
+  for (;;) {
+
+    // Evaluate and threhold status data
+    status();
+
+    // Save files every tSave period and print some info, energy is only
+    // needed for the output
+    if (system.time - lastSave >= savePeriod || system.time == initialTime ||
+        EXIT) {
+      lastSave = system.time;
+      system.computeTotalEnergy();
+      finitenessErrorBacktrace();
+      saveData();
+    }
+
+    // Process mesh every tProcessMesh period
+    if (system.time - lastProcessMesh > processMeshPeriod) {
+      lastProcessMesh = system.time;
+      system.mutateMesh();
+      system.updateConfigurations(false);
+    }
+
+    // update geodesics every tUpdateGeodesics period
+    if (system.time - lastUpdateGeodesics > updateGeodesicsPeriod) {
+      lastUpdateGeodesics = system.time;
+      system.updateConfigurations(true);
+    }
+
+    // break loop if EXIT flag is on
+    if (EXIT) {
+      break;
+    }
+
+    // step forward, the inertia is meaningless across mesh processing
+    if (system.time == lastProcessMesh || system.time == lastUpdateGeodesics) {
+      system.time += 1e-10 * characteristicTimeStep;
+      resetDynamics();
+    } else {
+      march();
+    }
+  }
+
+  // write the queued frames and release the file before it is renamed
+#ifdef MEM3DG_WITH_NETCDF
+  trajectoryWriter.stop();
+#endif
+
+  // return if optimization is sucessful
+  if (!SUCCESS) {
+    if (tolerance == 0) {
+      markFileName("_most");
+    } else {
+      markFileName("_failed");
+    }
+  }
+
+  // stop the timer and report time spent
+#ifdef __linux__
+  double duration = getDuration(start);
+  if (verbosity > 0) {
+    std::cout << "\nTotal integration time: " << duration << " seconds"
+              << std::endl;
+  }
+#endif
+
+  return SUCCESS;
+}
+
+void FIRE::checkParameters() {
+  if (system.parameters.dpd.gamma != 0) {
+    mem3dg_runtime_error("DPD has to be turned off for FIRE integration!");
+  }
+  if (system.parameters.damping != 0) {
+    mem3dg_runtime_error("Damping to be 0 for FIRE integration!");
+  }
+  if (system.parameters.proteinMobility != 1 &&
+      system.parameters.proteinMobility != 0) {
+    mem3dg_runtime_error("Protein mobility constant should "
+                         "be set to 1 for optimization!");
+  }
+  if (timeStepIncrease <= 1 || timeStepDecrease >= 1 ||
+      timeStepDecrease <= 0) {
+    mem3dg_runtime_error("timeStepIncrease > 1 and 0 < timeStepDecrease < 1!");
+  }
+  if (initialMixing <= 0 || initialMixing >= 1 || mixingDecrease <= 0 ||
+      mixingDecrease >= 1) {
+    mem3dg_runtime_error("0 < initialMixing < 1 and 0 < mixingDecrease < 1!");
+  }
+  if (minTimeStepFactor <= 0 || minTimeStepFactor > 1 ||
+      maxTimeStepFactor < 1) {
+    mem3dg_runtime_error("0 < minTimeStepFactor <= 1 <= maxTimeStepFactor!");
+  }
+  if (system.parameters.external.Kf != 0) {
+    mem3dg_runtime_error(
+        "External force can not be applied using energy optimization")
+  }
+}
+
+void FIRE::resetDynamics() {
+  toMatrix(system.velocity).setZero();
+  system.proteinVelocity.raw().setZero();
+  timeStep = characteristicTimeStep;
+  mixing = initialMixing;
+  positivePowerCount = 0;
+}
+
+void FIRE::status() {
+  // compute summerized forces
+  system.computePhysicalForcing(timeStep);
+
+  // compute the contraint error
+  areaDifference = abs(system.surfaceArea / system.parameters.tension.At - 1);
+  volumeDifference = (system.parameters.osmotic.isPreferredVolume)
+                         ? abs(system.volume / system.parameters.osmotic.Vt - 1)
+                         : abs(system.parameters.osmotic.n / system.volume /
+                                   system.parameters.osmotic.cam -
+                               1.0);
+
+  // exit if under error tolerance
+  if (system.mechErrorNorm < tolerance && system.chemErrorNorm < tolerance) {
+    std::cout << "\nError norm smaller than tolerance." << std::endl;
+    EXIT = true;
+  }
+
+  // exit if reached time
+  if (system.time > totalTime) {
+    std::cout << "\nReached time." << std::endl;
+    EXIT = true;
+    SUCCESS = false;
+  }
+
+  // exit if interrupted, saving the last frame
+  if (interruptSignal() != 0) {
+    std::cout << "\nInterrupted." << std::endl;
+    EXIT = true;
+    SUCCESS = false;
+  }
+
+  // backtracking for error
+  finitenessErrorBacktrace();
+}
+
+void FIRE::march() {
+  // map the raw eigen datatype for computation
+  auto velocity = toMatrix(system.velocity);
+  auto &proteinVelocity = system.proteinVelocity.raw();
+  auto force = toMatrix(system.forces.mechanicalForceVec);
+  const EigenVectorX1d chemicalForce =
+      system.parameters.proteinMobility * system.forces.chemicalPotential.raw();
+
+  // adjust time step if adopt adaptive time step based on mesh size
+  if (isAdaptiveStep) {
+    characteristicTimeStep = updateAdaptiveCharacteristicStep();
+  }
+  const double maxTimeStep = maxTimeStepFactor * characteristicTimeStep;
+  const double minTimeStep = minTimeStepFactor * characteristicTimeStep;
+
+  // adapt the time step and mixing on the power of the force
+  const double power = (force.array() * velocity.array()).sum() +
+                       chemicalForce.dot(proteinVelocity);
+  if (power > 0) {
+    if (++positivePowerCount > delayStep) {
+      timeStep = std::min(timeStep * timeStepIncrease, maxTimeStep);
+      mixing *= mixingDecrease;
+    }
+  } else {
+    positivePowerCount = 0;
+    timeStep = std::max(timeStep * timeStepDecrease, minTimeStep);
+    mixing = initialMixing;
+    // step back half way to the uphill point before stopping
+    toMatrix(system.vpg->inputVertexPositions) -= 0.5 * timeStep * velocity;
+    system.proteinDensity.raw() -= 0.5 * timeStep * proteinVelocity;
+    velocity.setZero();
+    proteinVelocity.setZero();
+  }
+
+  // semi-implicit Euler with velocity mixed toward the force direction
+  velocity += timeStep * force;
+  proteinVelocity += timeStep * chemicalForce;
+  const double forceNorm =
+      std::sqrt(force.squaredNorm() + chemicalForce.squaredNorm());
+  if (forceNorm > 0) {
+    const double velocityNorm =
+        std::sqrt(velocity.squaredNorm() + proteinVelocity.squaredNorm());
+    velocity = (1 - mixing) * velocity +
+               (mixing * velocityNorm / forceNorm) * force;
+    proteinVelocity = (1 - mixing) * proteinVelocity +
+                      (mixing * velocityNorm / forceNorm) * chemicalForce;
+  }
+  system.vpg->inputVertexPositions += system.velocity * timeStep;
+  system.proteinDensity += system.proteinVelocity * timeStep;
+  system.time += timeStep;
+
+  // regularization
+  if (system.meshProcessor.isMeshRegularize) {
+    system.computeRegularizationForce();
+    system.vpg->inputVertexPositions.raw() +=
+        system.forces.regularizationForce.raw();
+  }
+
+  // recompute cached values
+  system.updateConfigurations(false);
+}
+} // namespace integrator
+} // namespace solver
+} // namespace mem3dg
@@ -36,7 +36,10 @@ namespace gc = ::geometrycentral;
 
 bool Euler::integrate() {
 
-  signal(SIGINT, signalHandler);
+  interruptSignal() = 0;
+  // the previous handler is restored on return
+  ScopedSignalHandler sigintHandler(
+      SIGINT, isSyncOnInterrupt ? interruptHandler : signalHandler);
 
 #ifdef __linux__
   // start the timer
@@ -119,6 +122,11 @@ bool Euler::integrate() {
     }
   }
 
+  // write the queued frames and release the file before it is renamed
+#ifdef MEM3DG_WITH_NETCDF
+  trajectoryWriter.stop();
+#endif
+
   // return if optimization is sucessful
   if (!SUCCESS) {
     if (tolerance == 0) {
@@ -178,6 +186,13 @@ void Euler::status() {
     SUCCESS = false;
   }
 
+  // exit if interrupted, saving the last frame
+  if (interruptSignal() != 0) {
+    std::cout << "\nInterrupted." << std::endl;
+    EXIT = true;
+    SUCCESS = false;
+  }
+
   // compute the free energy of the system
   if (system.parameters.external.Kf != 0)
     system.computeExternalWork(system.time, timeStep);
@@ -190,8 +205,12 @@ void Euler::status() {
 void Euler::march() {
   // compute force, which is equivalent to velocity
   system.velocity = system.forces.mechanicalForceVec;
-  system.proteinVelocity =
-      system.parameters.proteinMobility * system.forces.chemicalPotential;
+  if (isSobolevPreconditioned &&
+      system.parameters.variation.isShapeVariation) {
+    toMatrix(system.velocity) =
+        sobolevPrecondition(toMatrix(system.forces.mechanicalForceVec));
+  }
+  system.proteinVelocity.raw() = explicitProteinVelocity();
 
   // adjust time step if adopt adaptive time step based on mesh size
   if (isAdaptiveStep) {
@@ -199,21 +218,39 @@ void Euler::march() {
   }
 
   // time stepping on vertex position
-  if (isBacktrack) {
-    double timeStep_mech,
-        timeStep_chem = std::numeric_limits<double>::infinity();
-    if (system.parameters.variation.isShapeVariation)
-      timeStep_mech = mechanicalBacktrack(toMatrix(system.velocity), rho, c1);
-    if (system.parameters.variation.isProteinVariation)
-      timeStep_chem =
-          chemicalBacktrack(toMatrix(system.proteinVelocity), rho, c1);
-    timeStep = (timeStep_chem < timeStep_mech) ? timeStep_chem : timeStep_mech;
+  const bool isShapeVariation = system.parameters.variation.isShapeVariation;
+  const bool isProteinVariation =
+      system.parameters.variation.isProteinVariation;
+  if (isBacktrack && isProteinVariation && isImplicitProteinDiffusion) {
+    mem3dg_runtime_error("Implicit protein diffusion requires a fixed time "
+                         "step, turn off backtracking!");
+  }
+  if (isBacktrack && isShapeVariation != isProteinVariation) {
+    // the line search leaves the system at the accepted step
+    timeStep =
+        isShapeVariation
+            ? mechanicalBacktrack(toMatrix(system.velocity), rho, c1)
+            : chemicalBacktrack(toMatrix(system.proteinVelocity), rho, c1);
   } else {
-    timeStep = characteristicTimeStep;
+    if (isBacktrack && isShapeVariation) {
+      // both searches start from the same configuration, step by the smaller
+      double timeStep_mech =
+          mechanicalBacktrack(toMatrix(system.velocity), rho, c1);
+      restoreLineSearchSnapshot();
+      double timeStep_chem =
+          chemicalBacktrack(toMatrix(system.proteinVelocity), rho, c1);
+      restoreLineSearchSnapshot();
+      timeStep =
+          (timeStep_chem < timeStep_mech) ? timeStep_chem : timeStep_mech;
+    } else {
+      timeStep = characteristicTimeStep;
+    }
+    system.vpg->inputVertexPositions += system.velocity * timeStep;
+    system.proteinDensity += system.proteinVelocity * timeStep;
+    if (isProteinVariation)
+      implicitProteinDiffusion(timeStep);
+    system.time += timeStep;
   }
-  system.vpg->inputVertexPositions += system.velocity * timeStep;
-  system.proteinDensity += system.proteinVelocity * timeStep;
-  system.time += timeStep;
 
   // regularization
   if (system.meshProcessor.isMeshRegularize) {
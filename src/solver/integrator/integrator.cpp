@@ -18,7 +18,9 @@
 #include "mem3dg/type_utilities.h"
 #include "mem3dg/version.h"
 
+#include <algorithm>
 #include <cmath>
+#include <limits>
 #include <geometrycentral/utilities/eigen_interop_helpers.h>
 
 #include <fstream>
@@ -29,6 +31,44 @@ namespace mem3dg {
 namespace solver {
 namespace integrator {
 
+namespace {
+/// minimizer of the quadratic through phi(a0), phi'(a0) and phi(a1)
+double quadraticStep(double a0, double phi0, double dphi0, double a1,
+                     double phi1) {
+  const double da = a1 - a0;
+  return a0 - dphi0 * da * da / (2 * (phi1 - phi0 - dphi0 * da));
+}
+
+/// minimizer of the cubic through phi(0), phi'(0), phi(a0) and phi(a1)
+double cubicStep(double phi0, double dphi0, double a0, double phiA0,
+                 double a1, double phiA1) {
+  const double d0 = phiA0 - phi0 - dphi0 * a0;
+  const double d1 = phiA1 - phi0 - dphi0 * a1;
+  const double denominator = a0 * a0 * a1 * a1 * (a1 - a0);
+  const double a = (a0 * a0 * d1 - a1 * a1 * d0) / denominator;
+  const double b = (-a0 * a0 * a0 * d1 + a1 * a1 * a1 * d0) / denominator;
+  if (a == 0)
+    return -dphi0 / (2 * b);
+  return (-b + std::sqrt(b * b - 3 * a * dphi0)) / (3 * a);
+}
+
+/// minimizer of the cubic Hermite interpolant on [a0, a1]
+double hermiteStep(double a0, double phi0, double dphi0, double a1,
+                   double phi1, double dphi1) {
+  const double d1 = dphi0 + dphi1 - 3 * (phi0 - phi1) / (a0 - a1);
+  const double d2 =
+      std::copysign(std::sqrt(d1 * d1 - dphi0 * dphi1), a1 - a0);
+  return a1 - (a1 - a0) * (dphi1 + d2 - d1) / (dphi1 - dphi0 + 2 * d2);
+}
+
+/// keep the trial step strictly inside [lower, upper], bisect if not finite
+double safeguardStep(double alpha, double lower, double upper) {
+  if (!std::isfinite(alpha))
+    return 0.5 * (lower + upper);
+  return std::min(std::max(alpha, lower), upper);
+}
+} // namespace
+
 double Integrator::updateAdaptiveCharacteristicStep() {
   double currentMinimumSize = system.vpg->edgeLengths.raw().minCoeff();
   double currentMaximumForce =
@@ -38,6 +78,9 @@ double Integrator::updateAdaptiveCharacteristicStep() {
 
   double dt = (dt_size2_ratio * currentMinimumSize * currentMinimumSize) *
               (initialMaximumForce / currentMaximumForce);
+  // the Sobolev metric relaxes the stability limit of the bare gradient flow
+  if (isSobolevPreconditioned && system.parameters.variation.isShapeVariation)
+    dt *= sobolevStepGain;
 
   if (characteristicTimeStep / dt > 1e3) {
     mem3dg_runtime_message("Time step too small! May consider restarting the "
@@ -54,13 +97,214 @@ double Integrator::updateAdaptiveCharacteristicStep() {
   return dt;
 }
 
+EigenVectorX3dr Integrator::sobolevPrecondition(const EigenVectorX3dr &force) {
+  if (sobolevScale < 0) {
+    mem3dg_runtime_error("Sobolev scale has to be non-negative!");
+  }
+  if (sobolevRefactorizationPeriod == 0) {
+    mem3dg_runtime_error("Sobolev refactorization period has to be positive!");
+  }
+
+  // the operators are only required for the duration of the call, such that
+  // the system does not keep refreshing them once preconditioning is over
+  system.vpg->requireVertexLumpedMassMatrix();
+  const Eigen::SparseMatrix<double> M = system.vpg->vertexLumpedMassMatrix;
+  system.vpg->unrequireVertexLumpedMassMatrix();
+  const Eigen::VectorXd mass = M.diagonal();
+
+  bool isNewPattern = system.isPreconditionerOutdated ||
+                      sobolevMetric.rows() != mass.size();
+  if (isNewPattern || !isSobolevFactorized ||
+      sobolevFactorizationAge >= sobolevRefactorizationPeriod) {
+    const double meanEdgeLength = system.vpg->edgeLengths.raw().mean();
+    const double tau = sobolevScale * meanEdgeLength * meanEdgeLength;
+    system.vpg->requireCotanLaplacian();
+    const Eigen::SparseMatrix<double> A = M + tau * system.vpg->cotanLaplacian;
+    system.vpg->unrequireCotanLaplacian();
+    const Eigen::Index previousNonZeros = sobolevMetric.nonZeros();
+    sobolevMetric = A * mass.cwiseInverse().asDiagonal() * A;
+
+    // the metric slows a mode of M^-1 L with eigenvalue lambda down by
+    // (1 + tau lambda)^2. For a stiffness growing at least linearly in lambda,
+    // the fastest preconditioned rate is smaller than the bare one by
+    // (1 + x)^2 if x <= 1 and 4 x otherwise, x = tau lambda_max. The Rayleigh
+    // quotients of the unit vectors bound x from below
+    const double x = (A.diagonal() - mass).cwiseQuotient(mass).maxCoeff();
+    sobolevStepGain = x <= 1 ? (1 + x) * (1 + x) : 4 * x;
+
+    // the cotan Laplacian is positive semidefinite, so A and A M^-1 A are
+    // positive definite. The pattern only depends on the topology
+    if (isNewPattern || sobolevMetric.nonZeros() != previousNonZeros) {
+      sobolevSolver.analyzePattern(sobolevMetric);
+      system.isPreconditionerOutdated = false;
+    }
+    sobolevSolver.factorize(sobolevMetric);
+    isSobolevFactorized = (sobolevSolver.info() == Eigen::Success);
+    sobolevFactorizationAge = 0;
+    if (!isSobolevFactorized) {
+      mem3dg_runtime_message(
+          "Sobolev metric factorization failed, use bare gradient!");
+      sobolevStepGain = 1;
+      return force;
+    }
+  }
+  sobolevFactorizationAge++;
+
+  Eigen::Matrix<double, Eigen::Dynamic, 3> rhs = mass.mean() * force;
+  Eigen::Matrix<double, Eigen::Dynamic, 3> direction =
+      sobolevSolver.solve(rhs);
+  return system.forces.maskForce(EigenVectorX3dr(direction));
+}
+
+EigenVectorX1d Integrator::explicitProteinVelocity() {
+  if (isImplicitProteinDiffusion && system.parameters.dirichlet.eta != 0) {
+    return system.parameters.proteinMobility *
+           (system.forces.chemicalPotential.raw() -
+            system.forces.diffusionPotential.raw());
+  }
+  return system.parameters.proteinMobility *
+         system.forces.chemicalPotential.raw();
+}
+
+void Integrator::implicitProteinDiffusion(double dt) {
+  const double coefficient = dt * system.parameters.dirichlet.eta *
+                             system.parameters.proteinMobility;
+  if (!isImplicitProteinDiffusion || coefficient == 0)
+    return;
+  if (coefficient < 0) {
+    mem3dg_runtime_error("Implicit diffusion requires positive eta, mobility "
+                         "and time step!");
+  }
+
+  // the cotan Laplacian is kept up to date as long as eta != 0
+  const Eigen::SparseMatrix<double> &L = system.vpg->cotanLaplacian;
+  const EigenVectorX1d &mask = system.forces.proteinMask.raw();
+  const Eigen::Index nNonZeros = L.nonZeros();
+
+  // the pattern changes with the topology or the set of fixed vertices
+  bool isNewPattern =
+      diffusionLaplacian.rows() != L.rows() ||
+      diffusionLaplacian.nonZeros() != nNonZeros ||
+      !std::equal(L.outerIndexPtr(), L.outerIndexPtr() + L.outerSize() + 1,
+                  diffusionLaplacian.outerIndexPtr()) ||
+      !std::equal(L.innerIndexPtr(), L.innerIndexPtr() + nNonZeros,
+                  diffusionLaplacian.innerIndexPtr()) ||
+      diffusionMask != mask;
+  bool isDrifted =
+      isNewPattern ||
+      std::abs(coefficient - diffusionCoefficient) >
+          diffusionRefactorizationTolerance * diffusionCoefficient ||
+      (Eigen::Map<const Eigen::VectorXd>(L.valuePtr(), nNonZeros) -
+       Eigen::Map<const Eigen::VectorXd>(diffusionLaplacian.valuePtr(),
+                                         nNonZeros))
+              .norm() >
+          diffusionRefactorizationTolerance *
+              Eigen::Map<const Eigen::VectorXd>(diffusionLaplacian.valuePtr(),
+                                                nNonZeros)
+                  .norm();
+
+  if (isDrifted) {
+    diffusionLaplacian = L;
+    diffusionLaplacian.makeCompressed();
+    diffusionMask = mask;
+    diffusionCoefficient = coefficient;
+
+    // couplings to fixed vertices are moved to the right hand side, which
+    // keeps the operator symmetric
+    std::vector<Eigen::Triplet<double>> triplets;
+    triplets.reserve(nNonZeros + L.rows());
+    for (Eigen::Index i = 0; i < L.rows(); ++i) {
+      triplets.emplace_back(i, i, 1.0);
+    }
+    for (Eigen::Index k = 0; k < L.outerSize(); ++k) {
+      for (Eigen::SparseMatrix<double>::InnerIterator it(L, k); it; ++it) {
+        if (mask[it.row()] != 0 && mask[it.col()] != 0)
+          triplets.emplace_back(it.row(), it.col(), coefficient * it.value());
+      }
+    }
+    Eigen::SparseMatrix<double> diffusionOperator(L.rows(), L.cols());
+    diffusionOperator.setFromTriplets(triplets.begin(), triplets.end());
+    if (isNewPattern)
+      diffusionSolver.analyzePattern(diffusionOperator);
+    diffusionSolver.factorize(diffusionOperator);
+    if (diffusionSolver.info() != Eigen::Success) {
+      diffusionLaplacian.resize(0, 0);
+      mem3dg_runtime_error("Implicit diffusion factorization failed!");
+    }
+  }
+
+  EigenVectorX1d rhs = system.proteinDensity.raw();
+  for (Eigen::Index k = 0; k < diffusionLaplacian.outerSize(); ++k) {
+    for (Eigen::SparseMatrix<double>::InnerIterator it(diffusionLaplacian, k);
+         it; ++it) {
+      if (mask[it.row()] != 0 && mask[it.col()] == 0)
+        rhs[it.row()] -= diffusionCoefficient * it.value() *
+                         system.proteinDensity.raw()[it.col()];
+    }
+  }
+  system.proteinDensity.raw() = diffusionSolver.solve(rhs);
+}
+
+void Integrator::captureLineSearchSnapshot() {
+  // assignments reuse the storage as long as the mesh size is unchanged
+  LineSearchSnapshot &snapshot = lineSearchSnapshot;
+  snapshot.position = toMatrix(system.vpg->inputVertexPositions);
+  snapshot.proteinDensity = system.proteinDensity.raw();
+  snapshot.mechanicalForceVec = toMatrix(system.forces.mechanicalForceVec);
+  snapshot.mechanicalForce = system.forces.mechanicalForce.raw();
+  snapshot.chemicalPotential = system.forces.chemicalPotential.raw();
+  snapshot.mechErrorNorm = system.mechErrorNorm;
+  snapshot.chemErrorNorm = system.chemErrorNorm;
+  snapshot.time = system.time;
+  snapshot.energy = system.energy;
+}
+
+void Integrator::restoreLineSearchForces() {
+  toMatrix(system.forces.mechanicalForceVec) =
+      lineSearchSnapshot.mechanicalForceVec;
+  system.forces.mechanicalForce.raw() = lineSearchSnapshot.mechanicalForce;
+  system.forces.chemicalPotential.raw() = lineSearchSnapshot.chemicalPotential;
+  system.mechErrorNorm = lineSearchSnapshot.mechErrorNorm;
+  system.chemErrorNorm = lineSearchSnapshot.chemErrorNorm;
+}
+
+void Integrator::restoreLineSearchSnapshot() {
+  toMatrix(system.vpg->inputVertexPositions) = lineSearchSnapshot.position;
+  system.proteinDensity.raw() = lineSearchSnapshot.proteinDensity;
+  system.time = lineSearchSnapshot.time;
+  system.updateConfigurations(false);
+  // the energy is a function of the configuration, no need to recompute
+  system.energy = lineSearchSnapshot.energy;
+  restoreLineSearchForces();
+}
+
+void Integrator::evaluateLineSearchTrial(
+    double alpha,
+    const Eigen::Matrix<double, Eigen::Dynamic, 3> &positionDirection,
+    const Eigen::Matrix<double, Eigen::Dynamic, 1> &chemicalDirection,
+    bool isShape, bool isProtein) {
+  if (isShape) {
+    toMatrix(system.vpg->inputVertexPositions) =
+        lineSearchSnapshot.position + alpha * positionDirection;
+  }
+  if (isProtein) {
+    system.proteinDensity.raw() =
+        lineSearchSnapshot.proteinDensity + alpha * chemicalDirection;
+  }
+  system.time = lineSearchSnapshot.time + alpha;
+  system.updateConfigurations(false);
+  system.computePotentialEnergy();
+  lineSearchEvaluationCount++;
+}
+
 double Integrator::backtrack(
     Eigen::Matrix<double, Eigen::Dynamic, 3> &&positionDirection,
     Eigen::Matrix<double, Eigen::Dynamic, 1> &&chemicalDirection, double rho,
     double c1) {
 
-  // cache energy of the last time step
-  const Energy previousE = system.energy;
+  // snapshot the configuration the line search starts from
+  captureLineSearchSnapshot();
+  const Energy &previousE = lineSearchSnapshot.energy;
 
   // validate the directions
   double positionProjection = 0;
@@ -78,6 +322,8 @@ double Integrator::backtrack(
       positionProjection = (toMatrix(system.forces.mechanicalForceVec).array() *
                             positionDirection.array())
                                .sum();
+      // the next direction is built from the step actually taken
+      toMatrix(system.velocity) = positionDirection;
     }
   }
   if (system.parameters.variation.isProteinVariation) {
@@ -94,30 +340,26 @@ double Integrator::backtrack(
       chemicalProjection = (system.forces.chemicalPotential.raw().array() *
                             chemicalDirection.array())
                                .sum();
+      system.proteinVelocity.raw() = chemicalDirection;
     }
   }
 
-  // calculate initial energy as reference level
-  gc::VertexData<gc::Vector3> initial_pos(*system.mesh);
-  initial_pos = system.vpg->inputVertexPositions;
-  gc::VertexData<double> initial_protein(*system.mesh,
-                                         system.proteinDensity.raw());
-  const double init_time = system.time;
+  if (isInterpolatingLineSearch) {
+    return interpolatingLineSearch(
+        positionDirection, chemicalDirection,
+        system.parameters.variation.isShapeVariation,
+        system.parameters.variation.isProteinVariation,
+        positionProjection + chemicalProjection, c1, backtrackHistory);
+  }
 
   // declare variables used in backtracking iterations
   double alpha = characteristicTimeStep;
   std::size_t count = 0;
 
   // zeroth iteration
-  if (system.parameters.variation.isShapeVariation) {
-    toMatrix(system.vpg->inputVertexPositions) += alpha * positionDirection;
-  }
-  if (system.parameters.variation.isProteinVariation) {
-    system.proteinDensity.raw() += alpha * chemicalDirection;
-  }
-  system.time += alpha;
-  system.updateConfigurations(false);
-  system.computePotentialEnergy();
+  evaluateLineSearchTrial(alpha, positionDirection, chemicalDirection,
+                          system.parameters.variation.isShapeVariation,
+                          system.parameters.variation.isProteinVariation);
 
   while (true) {
     // Wolfe condition fulfillment
@@ -132,13 +374,18 @@ double Integrator::backtrack(
       mem3dg_runtime_message("line search failure! Simulation "
                              "stopped. \n");
       std::cout << "\nError backtrace using alpha: \n" << std::endl;
-      lineSearchErrorBacktrace(alpha, toMatrix(initial_pos),
-                               toMatrix(initial_protein), previousE, true);
+      lineSearchErrorBacktrace(alpha, lineSearchSnapshot.position,
+                               lineSearchSnapshot.proteinDensity, previousE,
+                               true);
       std::cout << "\nError backtrace using characteristicTimeStep: \n"
                 << std::endl;
-      lineSearchErrorBacktrace(characteristicTimeStep,
-                               toMatrix(system.vpg->inputVertexPositions),
-                               toMatrix(initial_protein), previousE, true);
+      lineSearchErrorBacktrace(
+          characteristicTimeStep, lineSearchSnapshot.position,
+          lineSearchSnapshot.proteinDensity, previousE, true);
+      // the error backtrace perturbs the configuration
+      evaluateLineSearchTrial(alpha, positionDirection, chemicalDirection,
+                              system.parameters.variation.isShapeVariation,
+                              system.parameters.variation.isProteinVariation);
       EXIT = true;
       SUCCESS = false;
       break;
@@ -146,22 +393,16 @@ double Integrator::backtrack(
 
     // backtracking time step
     alpha *= rho;
-    if (system.parameters.variation.isShapeVariation) {
-      toMatrix(system.vpg->inputVertexPositions) =
-          toMatrix(initial_pos) + alpha * positionDirection;
-    }
-    if (system.parameters.variation.isProteinVariation) {
-      system.proteinDensity.raw() =
-          toMatrix(initial_protein) + alpha * chemicalDirection;
-    }
-    system.time = init_time + alpha;
-    system.updateConfigurations(false);
-    system.computePotentialEnergy();
+    evaluateLineSearchTrial(alpha, positionDirection, chemicalDirection,
+                            system.parameters.variation.isShapeVariation,
+                            system.parameters.variation.isProteinVariation);
 
     // count the number of iterations
     count++;
   }
 
+  lineSearchCount++;
+
   // report the backtracking if verbose
   if (alpha != characteristicTimeStep && verbosity > 3) {
     std::cout << "alpha: " << characteristicTimeStep << " -> " << alpha
@@ -173,24 +414,24 @@ double Integrator::backtrack(
   // If needed to test force-energy test
   const bool isDebug = false;
   if (isDebug) {
-    lineSearchErrorBacktrace(alpha, toMatrix(initial_pos),
-                             toMatrix(initial_protein), previousE, isDebug);
+    lineSearchErrorBacktrace(alpha, lineSearchSnapshot.position,
+                             lineSearchSnapshot.proteinDensity, previousE,
+                             isDebug);
+    evaluateLineSearchTrial(alpha, positionDirection, chemicalDirection,
+                            system.parameters.variation.isShapeVariation,
+                            system.parameters.variation.isProteinVariation);
   }
 
-  // recover the initial configuration
-  system.time = init_time;
-  system.proteinDensity = initial_protein;
-  system.vpg->inputVertexPositions = initial_pos;
-  system.updateConfigurations(false);
-  system.computePotentialEnergy();
+  // the system is left at the accepted step
   return alpha;
 }
 double Integrator::chemicalBacktrack(
     Eigen::Matrix<double, Eigen::Dynamic, 1> &&chemicalDirection, double rho,
     double c1) {
 
-  // cache energy of the last time step
-  const Energy previousE = system.energy;
+  // snapshot the configuration the line search starts from
+  captureLineSearchSnapshot();
+  const Energy &previousE = lineSearchSnapshot.energy;
 
   // validate the directions
   double chemicalProjection = 0;
@@ -207,24 +448,24 @@ double Integrator::chemicalBacktrack(
     chemicalProjection = (system.forces.chemicalPotential.raw().array() *
                           chemicalDirection.array())
                              .sum();
+    // the next direction is built from the step actually taken
+    system.proteinVelocity.raw() = chemicalDirection;
   }
 
-  // calculate initial energy as reference level
-  gc::VertexData<gc::Vector3> initial_pos(*system.mesh);
-  initial_pos = system.vpg->inputVertexPositions;
-  gc::VertexData<double> initial_protein(*system.mesh,
-                                         system.proteinDensity.raw());
-  const double init_time = system.time;
+  if (isInterpolatingLineSearch) {
+    return interpolatingLineSearch(Eigen::Matrix<double, Eigen::Dynamic, 3>(),
+                                   chemicalDirection, false, true,
+                                   chemicalProjection, c1,
+                                   chemicalBacktrackHistory);
+  }
 
   // declare variables used in backtracking iterations
   double alpha = characteristicTimeStep;
   std::size_t count = 0;
 
   // zeroth iteration
-  system.proteinDensity.raw() += alpha * chemicalDirection;
-  system.time += alpha;
-  system.updateConfigurations(false);
-  system.computePotentialEnergy();
+  evaluateLineSearchTrial(alpha, Eigen::Matrix<double, Eigen::Dynamic, 3>(),
+                          chemicalDirection, false, true);
 
   while (true) {
     // Wolfe condition fulfillment
@@ -239,12 +480,17 @@ double Integrator::chemicalBacktrack(
           "\nchemicalBacktrack: line search failure! Simulation "
           "stopped. \n");
       std::cout << "\nError backtrace using alpha: \n" << std::endl;
-      lineSearchErrorBacktrace(alpha, toMatrix(initial_pos),
-                               toMatrix(initial_protein), previousE, true);
+      lineSearchErrorBacktrace(alpha, lineSearchSnapshot.position,
+                               lineSearchSnapshot.proteinDensity, previousE,
+                               true);
       std::cout << "\nError backtrace using characteristicTimeStep: \n"
                 << std::endl;
-      lineSearchErrorBacktrace(characteristicTimeStep, toMatrix(initial_pos),
-                               toMatrix(initial_protein), previousE, true);
+      lineSearchErrorBacktrace(
+          characteristicTimeStep, lineSearchSnapshot.position,
+          lineSearchSnapshot.proteinDensity, previousE, true);
+      // the error backtrace perturbs the configuration
+      evaluateLineSearchTrial(alpha, Eigen::Matrix<double, Eigen::Dynamic, 3>(),
+                              chemicalDirection, false, true);
       EXIT = true;
       SUCCESS = false;
       break;
@@ -252,16 +498,15 @@ double Integrator::chemicalBacktrack(
 
     // backtracking time step
     alpha *= rho;
-    system.proteinDensity.raw() =
-        toMatrix(initial_protein) + alpha * chemicalDirection;
-    system.time = init_time + alpha;
-    system.updateConfigurations(false);
-    system.computePotentialEnergy();
+    evaluateLineSearchTrial(alpha, Eigen::Matrix<double, Eigen::Dynamic, 3>(),
+                            chemicalDirection, false, true);
 
     // count the number of iterations
     count++;
   }
 
+  lineSearchCount++;
+
   // report the backtracking if verbose
   if (alpha != characteristicTimeStep && verbosity > 3) {
     std::cout << "alpha: " << characteristicTimeStep << " -> " << alpha
@@ -272,16 +517,14 @@ double Integrator::chemicalBacktrack(
   const bool isDebug = false;
   if (isDebug) {
     std::cout << "\nchemicalBacktrack: debugging \n" << std::endl;
-    lineSearchErrorBacktrace(alpha, toMatrix(initial_pos),
-                             toMatrix(initial_protein), previousE, isDebug);
+    lineSearchErrorBacktrace(alpha, lineSearchSnapshot.position,
+                             lineSearchSnapshot.proteinDensity, previousE,
+                             isDebug);
+    evaluateLineSearchTrial(alpha, Eigen::Matrix<double, Eigen::Dynamic, 3>(),
+                            chemicalDirection, false, true);
   }
 
-  // recover the initial configuration
-  system.time = init_time;
-  system.proteinDensity = initial_protein;
-  system.vpg->inputVertexPositions = initial_pos;
-  system.updateConfigurations(false);
-  system.computePotentialEnergy();
+  // the system is left at the accepted step
   return alpha;
 }
 
@@ -289,8 +532,9 @@ double Integrator::mechanicalBacktrack(
     Eigen::Matrix<double, Eigen::Dynamic, 3> &&positionDirection, double rho,
     double c1) {
 
-  // cache energy of the last time step
-  const Energy previousE = system.energy;
+  // snapshot the configuration the line search starts from
+  captureLineSearchSnapshot();
+  const Energy &previousE = lineSearchSnapshot.energy;
 
   // validate the directions
   double positionProjection = 0;
@@ -307,24 +551,25 @@ double Integrator::mechanicalBacktrack(
     positionProjection = (toMatrix(system.forces.mechanicalForceVec).array() *
                           positionDirection.array())
                              .sum();
+    // the next direction is built from the step actually taken
+    toMatrix(system.velocity) = positionDirection;
   }
 
-  // calculate initial energy as reference level
-  gc::VertexData<gc::Vector3> initial_pos(*system.mesh);
-  initial_pos = system.vpg->inputVertexPositions;
-  gc::VertexData<double> initial_protein(*system.mesh,
-                                         system.proteinDensity.raw());
-  const double init_time = system.time;
+  if (isInterpolatingLineSearch) {
+    return interpolatingLineSearch(positionDirection,
+                                   Eigen::Matrix<double, Eigen::Dynamic, 1>(),
+                                   true, false, positionProjection, c1,
+                                   mechanicalBacktrackHistory);
+  }
 
   // declare variables used in backtracking iterations
   double alpha = characteristicTimeStep;
   std::size_t count = 0;
 
   // zeroth iteration
-  toMatrix(system.vpg->inputVertexPositions) += alpha * positionDirection;
-  system.time += alpha;
-  system.updateConfigurations(false);
-  system.computePotentialEnergy();
+  evaluateLineSearchTrial(alpha, positionDirection,
+                          Eigen::Matrix<double, Eigen::Dynamic, 1>(), true,
+                          false);
 
   while (true) {
     // Wolfe condition fulfillment
@@ -341,12 +586,18 @@ double Integrator::mechanicalBacktrack(
           "\nmechanicalBacktrack: line search failure! Simulation "
           "stopped. \n");
       std::cout << "\nError backtrace using alpha: \n" << std::endl;
-      lineSearchErrorBacktrace(alpha, toMatrix(initial_pos),
-                               toMatrix(initial_protein), previousE, true);
+      lineSearchErrorBacktrace(alpha, lineSearchSnapshot.position,
+                               lineSearchSnapshot.proteinDensity, previousE,
+                               true);
       std::cout << "\nError backtrace using characterisiticTimeStep: \n"
                 << std::endl;
-      lineSearchErrorBacktrace(characteristicTimeStep, toMatrix(initial_pos),
-                               toMatrix(initial_protein), previousE, true);
+      lineSearchErrorBacktrace(
+          characteristicTimeStep, lineSearchSnapshot.position,
+          lineSearchSnapshot.proteinDensity, previousE, true);
+      // the error backtrace perturbs the configuration
+      evaluateLineSearchTrial(alpha, positionDirection,
+                              Eigen::Matrix<double, Eigen::Dynamic, 1>(), true,
+                              false);
       EXIT = true;
       SUCCESS = false;
       break;
@@ -354,17 +605,16 @@ double Integrator::mechanicalBacktrack(
 
     // backtracking time step
     alpha *= rho;
-    toMatrix(system.vpg->inputVertexPositions) =
-        toMatrix(initial_pos) + alpha * positionDirection;
-
-    system.time = init_time + alpha;
-    system.updateConfigurations(false);
-    system.computePotentialEnergy();
+    evaluateLineSearchTrial(alpha, positionDirection,
+                            Eigen::Matrix<double, Eigen::Dynamic, 1>(), true,
+                            false);
 
     // count the number of iterations
     count++;
   }
 
+  lineSearchCount++;
+
   // report the backtracking if verbose
   if (alpha != characteristicTimeStep && verbosity > 3) {
     std::cout << "alpha: " << characteristicTimeStep << " -> " << alpha
@@ -375,25 +625,215 @@ double Integrator::mechanicalBacktrack(
   const bool isDebug = false;
   if (isDebug) {
     std::cout << "\nmechanicalBacktrack: debugging \n" << std::endl;
-    lineSearchErrorBacktrace(alpha, toMatrix(initial_pos),
-                             toMatrix(initial_protein), previousE, isDebug);
+    lineSearchErrorBacktrace(alpha, lineSearchSnapshot.position,
+                             lineSearchSnapshot.proteinDensity, previousE,
+                             isDebug);
+    evaluateLineSearchTrial(alpha, positionDirection,
+                            Eigen::Matrix<double, Eigen::Dynamic, 1>(), true,
+                            false);
   }
 
-  // recover the initial configuration
-  system.time = init_time;
-  system.proteinDensity = initial_protein;
-  system.vpg->inputVertexPositions = initial_pos;
-  system.updateConfigurations(false);
-  system.computePotentialEnergy();
+  // the system is left at the accepted step
+  return alpha;
+}
+
+double Integrator::interpolatingLineSearch(
+    const Eigen::Matrix<double, Eigen::Dynamic, 3> &positionDirection,
+    const Eigen::Matrix<double, Eigen::Dynamic, 1> &chemicalDirection,
+    bool isShape, bool isProtein, double projection, double c1,
+    LineSearchHistory &history) {
+  if (isStrongWolfe && (c2 <= c1 || c2 >= 1)) {
+    mem3dg_runtime_error("For strong Wolfe line search, 0<c1<c2<1!");
+  }
+
+  // the caller has taken the snapshot of the initial configuration
+  const Energy &previousE = lineSearchSnapshot.energy;
+
+  // energy along the direction, phi(alpha), net of the external work
+  double lastTrial = 0;
+  auto phi = [&](double alpha) {
+    evaluateLineSearchTrial(alpha, positionDirection, chemicalDirection,
+                            isShape, isProtein);
+    lastTrial = alpha;
+    double energy = system.energy.potentialEnergy -
+                    (isShape ? system.computeIntegratedPower(alpha) : 0);
+    return std::isfinite(energy) ? energy
+                                 : std::numeric_limits<double>::infinity();
+  };
+  // directional derivative phi'(alpha) at the last evaluated configuration
+  auto dphi = [&]() {
+    system.computePhysicalForcing();
+    double slope = 0;
+    if (isShape) {
+      slope -= (toMatrix(system.forces.mechanicalForceVec).array() *
+                positionDirection.array())
+                   .sum();
+    }
+    if (isProtein) {
+      slope -= (system.forces.chemicalPotential.raw().array() *
+                chemicalDirection.array())
+                   .sum();
+    }
+    return slope;
+  };
+
+  const double phi0 = previousE.potentialEnergy;
+  const double dphi0 = -projection;
+  const double maxStep = characteristicTimeStep;
+  const double minStep = 1e-5 * characteristicTimeStep;
+  auto isSufficientDecrease = [&](double alpha, double phiAlpha) {
+    return phiAlpha < phi0 + c1 * alpha * dphi0;
+  };
+  auto isCurvature = [&](double dphiAlpha) {
+    return std::abs(dphiAlpha) <= -c2 * dphi0;
+  };
+
+  // warm start, assume the first order change is the same as the last step
+  double alpha = maxStep;
+  if (history.step > 0 && history.projection > 0 && projection > 0) {
+    alpha = std::min(maxStep, std::max(minStep, history.step *
+                                                    history.projection /
+                                                    projection));
+  }
+
+  bool isAccepted = false;
+  if (!isStrongWolfe) {
+    // shrink by interpolation until the sufficient decrease condition holds
+    double alphaPrev = 0, phiPrev = phi0;
+    double phiAlpha = phi(alpha);
+    while (!(isAccepted = isSufficientDecrease(alpha, phiAlpha))) {
+      if (alpha < minStep)
+        break;
+      double alphaNext =
+          (alphaPrev == 0 || !std::isfinite(phiPrev))
+              ? quadraticStep(0, phi0, dphi0, alpha, phiAlpha)
+              : cubicStep(phi0, dphi0, alphaPrev, phiPrev, alpha, phiAlpha);
+      alphaPrev = alpha;
+      phiPrev = phiAlpha;
+      alpha = safeguardStep(alphaNext, 0.1 * alpha, 0.5 * alpha);
+      phiAlpha = phi(alpha);
+    }
+  } else {
+    // zoom into the bracket [lo, hi] that contains a strong Wolfe step,
+    // phi(lo) is the lowest sufficient decrease value found so far
+    double lo = 0, phiLo = phi0, dphiLo = dphi0;
+    double hi = 0, phiHi = phi0, dphiHi = dphi0;
+    bool isHiSlope = false, isBracketed = false;
+
+    // extrapolate until bracketed, but never beyond the characteristic step
+    double alphaPrev = 0, phiPrev = phi0, dphiPrev = dphi0;
+    for (;;) {
+      double phiAlpha = phi(alpha);
+      if (!isSufficientDecrease(alpha, phiAlpha) ||
+          (alphaPrev > 0 && phiAlpha >= phiPrev)) {
+        lo = alphaPrev, phiLo = phiPrev, dphiLo = dphiPrev;
+        hi = alpha, phiHi = phiAlpha, isHiSlope = false;
+        isBracketed = true;
+        break;
+      }
+      double dphiAlpha = dphi();
+      if (isCurvature(dphiAlpha) || alpha >= maxStep) {
+        isAccepted = true;
+        break;
+      }
+      if (dphiAlpha >= 0) {
+        lo = alpha, phiLo = phiAlpha, dphiLo = dphiAlpha;
+        hi = alphaPrev, phiHi = phiPrev, dphiHi = dphiPrev, isHiSlope = true;
+        isBracketed = true;
+        break;
+      }
+      alphaPrev = alpha, phiPrev = phiAlpha, dphiPrev = dphiAlpha;
+      alpha = std::min(maxStep, 2 * alpha);
+    }
+
+    const std::size_t maxZoom = 20;
+    for (std::size_t i = 0; isBracketed && i < maxZoom; ++i) {
+      if (std::abs(hi - lo) < minStep)
+        break;
+      double trial = isHiSlope
+                         ? hermiteStep(lo, phiLo, dphiLo, hi, phiHi, dphiHi)
+                         : quadraticStep(lo, phiLo, dphiLo, hi, phiHi);
+      const double margin = 0.1 * std::abs(hi - lo);
+      alpha = safeguardStep(trial, std::min(lo, hi) + margin,
+                            std::max(lo, hi) - margin);
+      double phiAlpha = phi(alpha);
+      if (!isSufficientDecrease(alpha, phiAlpha) || phiAlpha >= phiLo) {
+        hi = alpha, phiHi = phiAlpha, isHiSlope = false;
+        continue;
+      }
+      double dphiAlpha = dphi();
+      if (isCurvature(dphiAlpha)) {
+        isAccepted = true;
+        break;
+      }
+      if (dphiAlpha * (hi - lo) >= 0) {
+        hi = lo, phiHi = phiLo, dphiHi = dphiLo, isHiSlope = true;
+      }
+      lo = alpha, phiLo = phiAlpha, dphiLo = dphiAlpha;
+    }
+
+    // settle for sufficient decrease if the curvature condition is not met
+    if (!isAccepted && lo > 0) {
+      alpha = lo;
+      isAccepted = true;
+    }
+  }
+
+  if (!isAccepted) {
+    mem3dg_runtime_message("\ninterpolatingLineSearch: line search failure! "
+                           "Simulation stopped. \n");
+    std::cout << "\nError backtrace using alpha: \n" << std::endl;
+    lineSearchErrorBacktrace(alpha, lineSearchSnapshot.position,
+                             lineSearchSnapshot.proteinDensity, previousE,
+                             true);
+    // the error backtrace perturbs the configuration
+    lastTrial = 0;
+    EXIT = true;
+    SUCCESS = false;
+  }
+
+  // report the line search if verbose
+  if (alpha != characteristicTimeStep && verbosity > 3) {
+    std::cout << "alpha: " << characteristicTimeStep << " -> " << alpha
+              << std::endl;
+  }
+  lineSearchCount++;
+  history.step = alpha;
+  history.projection = projection;
+
+  // keep the accepted trial, which need not be the last one evaluated; the
+  // caller keeps reading the forces at the initial configuration, which slope
+  // evaluations overwrite
+  if (lastTrial != alpha) {
+    evaluateLineSearchTrial(alpha, positionDirection, chemicalDirection,
+                            isShape, isProtein);
+  }
+  if (isStrongWolfe) {
+    restoreLineSearchForces();
+  }
   return alpha;
 }
 
 void Integrator::lineSearchErrorBacktrace(
-    const double alpha, const EigenVectorX3dr currentPosition,
-    const EigenVectorX1d currentProteinDensity, const Energy previousEnergy,
+    const double alpha, const EigenVectorX3dr &currentPosition,
+    const EigenVectorX1d &currentProteinDensity, const Energy &previousEnergy,
     bool runAll) {
   std::cout << "\nlineSearchErrorBacktracking ..." << std::endl;
 
+  // force components are not kept during stepping in lean diagnostics,
+  // evaluate them at the configuration the line search started from
+  if (!system.forces.isFullDiagnostics) {
+    const EigenVectorX3dr position = toMatrix(system.vpg->inputVertexPositions);
+    const EigenVectorX1d proteinDensity = system.proteinDensity.raw();
+    toMatrix(system.vpg->inputVertexPositions) = currentPosition;
+    system.proteinDensity.raw() = currentProteinDensity;
+    system.updateConfigurations(false);
+    system.computeForceComponents();
+    toMatrix(system.vpg->inputVertexPositions) = position;
+    system.proteinDensity.raw() = proteinDensity;
+    system.updateConfigurations(false);
+  }
+
   // cache the energy when applied the total force
   // system.proteinDensity.raw() = currentProteinDensity;
   // toMatrix(system.vpg->inputVertexPositions) =
@@ -893,6 +1333,8 @@ void Integrator::finitenessErrorBacktrace() {
     }
 
     if (!std::isfinite(toMatrix(system.forces.mechanicalForceVec).norm())) {
+      if (!system.forces.isFullDiagnostics)
+        system.computeForceComponents();
       if (!std::isfinite(toMatrix(system.forces.capillaryForceVec).norm())) {
         mem3dg_runtime_message("Capillary force is not finite!");
       }
@@ -1084,6 +1526,10 @@ void Integrator::reducedVolumeThreshold(bool &EXIT,
 }
 
 void Integrator::saveData() {
+  // force components are only evaluated on save frames in lean diagnostics
+  if (!system.forces.isFullDiagnostics)
+    system.computeForceComponents();
+
   // threshold of verbosity level to output ply file
   int outputPly = 0;
 
@@ -1107,6 +1553,7 @@ void Integrator::saveData() {
 
   // print in-progress information in the console
   if (verbosity > 1) {
+    system.vpg->requireVertexGaussianCurvatures();
     std::cout << "\n"
               << "t: " << system.time << ", "
               << "n: " << frame << ", "
@@ -1146,6 +1593,10 @@ void Integrator::saveData() {
               << "\n"
               << "phi: [" << system.proteinDensity.raw().minCoeff() << ","
               << system.proteinDensity.raw().maxCoeff() << "]" << std::endl;
+    if (lineSearchCount > 0)
+      std::cout << "Line search: " << getAverageLineSearchEvaluations()
+                << " energy evaluations per step" << std::endl;
+    system.vpg->unrequireVertexGaussianCurvatures();
     // << "COM: "
     // << gc::EigenMap<double,
     // 3>(f.vpg->inputVertexPositions).colwise().sum() /
@@ -1206,7 +1657,8 @@ void Integrator::markFileName(std::string marker_str) {
 void Integrator::createNetcdfFile() {
   // initialize netcdf traj file
   trajFile.createNewFile(outputDirectory + "/" + trajFileName, *system.mesh,
-                         *system.vpg, TrajFile::NcFile::replace);
+                         *system.vpg, TrajFile::NcFile::replace,
+                         trajectoryStorage);
   trajFile.writeMask(toMatrix(system.forces.forceMask).rowwise().sum());
   if (!system.mesh->hasBoundary()) {
     trajFile.writeRefSurfArea(system.parameters.tension.At);
@@ -1216,7 +1668,9 @@ void Integrator::createNetcdfFile() {
 void Integrator::createMutableNetcdfFile() {
   // initialize netcdf traj file
   mutableTrajFile.createNewFile(outputDirectory + "/" + trajFileName,
-                                TrajFile::NcFile::replace);
+                                TrajFile::NcFile::replace,
+                                isChunkedTrajectory, trajectoryStorage);
+  isTopologySaved = false;
   // mutableTrajFile.writeMask(toMatrix(f.forces.forceMask).rowwise().sum());
   // if (!f.mesh->hasBoundary()) {
   //   mutableTrajFile.writeRefSurfArea(f.parameters.tension.At);
@@ -1273,9 +1727,11 @@ void Integrator::saveNetcdfData() {
     trajFile.writeMeanCurvature(idx,
                                 system.vpg->vertexMeanCurvatures.raw().array() /
                                     system.vpg->vertexDualAreas.raw().array());
+    system.vpg->requireVertexGaussianCurvatures();
     trajFile.writeGaussCurvature(
         idx, system.vpg->vertexGaussianCurvatures.raw().array() /
                  system.vpg->vertexDualAreas.raw().array());
+    system.vpg->unrequireVertexGaussianCurvatures();
     trajFile.writeSponCurvature(idx, system.H0.raw());
     // fd.writeAngles(idx, f.vpg.cornerAngles.raw());
     // fd.writeH_H0_diff(idx,
@@ -1294,12 +1750,48 @@ void Integrator::saveNetcdfData() {
 }
 
 void Integrator::saveMutableNetcdfData() {
+  if (isAsyncTrajectoryWriter) {
+    if (!trajectoryWriter.isRunning())
+      trajectoryWriter.start(mutableTrajFile, trajectoryQueueCapacity,
+                             syncPeriod);
+
+    // copy into the recycled buffers of the writer
+    TrajectoryWriter::Frame &snapshot = trajectoryWriter.acquire();
+    snapshot.time = system.time;
+    snapshot.velocity = toMatrix(system.velocity);
+    if (system.parameters.external.Kf != 0)
+      snapshot.externalForce = toMatrix(system.forces.externalForceVec);
+    else
+      snapshot.externalForce.resize(0, 3);
+    snapshot.coords = toMatrix(system.vpg->inputVertexPositions);
+    if (!isTopologySaved || system.topologyVersion != savedTopologyVersion)
+      snapshot.topology = system.mesh->getFaceVertexMatrix<std::uint32_t>();
+    else
+      snapshot.topology.resize(0, 3);
+    isTopologySaved = true;
+    savedTopologyVersion = system.topologyVersion;
+    snapshot.proteinDensity = system.proteinDensity.raw();
+    trajectoryWriter.push();
+
+    if (EXIT)
+      trajectoryWriter.flush();
+    return;
+  }
+
   std::size_t idx = mutableTrajFile.nFrames();
 
   // scalar quantities
   // write time
   mutableTrajFile.writeTime(idx, system.time);
 
+  // write topology first, which sets the epoch of the frame in chunked layout
+  if (!isTopologySaved || system.topologyVersion != savedTopologyVersion)
+    mutableTrajFile.writeTopology(idx, *system.mesh);
+  else
+    mutableTrajFile.writeTopologyReference(idx);
+  isTopologySaved = true;
+  savedTopologyVersion = system.topologyVersion;
+
   // write dynamic properties
   mutableTrajFile.writeVelocity(idx, system.velocity);
   if (system.parameters.external.Kf != 0)
@@ -1307,9 +1799,9 @@ void Integrator::saveMutableNetcdfData() {
 
   // write static properties
   mutableTrajFile.writeCoords(idx, *system.vpg);
-  mutableTrajFile.writeTopology(idx, *system.mesh);
   mutableTrajFile.writeProteinDensity(idx, system.proteinDensity);
-  mutableTrajFile.sync();
+  if (EXIT || (syncPeriod != 0 && (idx + 1) % syncPeriod == 0))
+    mutableTrajFile.sync();
 }
 #endif
 
@@ -1331,6 +1823,7 @@ void Integrator::getParameterLog(std::string inputMesh) {
            << "gamma:  " << system.parameters.dpd.gamma << "\n"
            << "Vt:     " << system.parameters.osmotic.Vt << "\n"
            << "kt:     " << system.parameters.temperature << "\n"
+           << "seed:   " << system.seed << "\n"
            << "Kf:     " << system.parameters.external.Kf << "\n";
 
     myfile << "\n";
@@ -1366,6 +1859,7 @@ void Integrator::getStatusLog(std::string nameOfFile, std::size_t frame,
            << "gamma:  " << system.parameters.dpd.gamma << "\n"
            << "Vt:     " << system.parameters.osmotic.Vt << "\n"
            << "kt:     " << system.parameters.temperature << "\n"
+           << "seed:   " << system.seed << "\n"
            << "Kf:   " << system.parameters.external.Kf << "\n";
 
     myfile << "\n";
@@ -37,7 +37,10 @@ namespace integrator {
 namespace gc = ::geometrycentral;
 
 bool VelocityVerlet::integrate() {
-  signal(SIGINT, signalHandler);
+  interruptSignal() = 0;
+  // the previous handler is restored on return
+  ScopedSignalHandler sigintHandler(
+      SIGINT, isSyncOnInterrupt ? interruptHandler : signalHandler);
 
 #ifdef __linux__
   // start the timer
@@ -97,6 +100,11 @@ bool VelocityVerlet::integrate() {
     }
   }
 
+  // write the queued frames and release the file before it is renamed
+#ifdef MEM3DG_WITH_NETCDF
+  trajectoryWriter.stop();
+#endif
+
   // return if physical simulation is sucessful
   if (!SUCCESS) {
     markFileName("_failed");
@@ -143,6 +151,13 @@ void VelocityVerlet::status() {
     EXIT = true;
   }
 
+  // exit if interrupted, saving the last frame
+  if (interruptSignal() != 0) {
+    std::cout << "\nInterrupted." << std::endl;
+    EXIT = true;
+    SUCCESS = false;
+  }
+
   // compute the free energy of the system
   if (system.parameters.external.Kf != 0)
     system.computeExternalWork(system.time, timeStep);
@@ -199,9 +214,9 @@ void VelocityVerlet::march() {
 
   // time stepping on protein density
   if (system.parameters.variation.isProteinVariation) {
-    system.proteinVelocity =
-        system.parameters.proteinMobility * system.forces.chemicalPotential;
+    system.proteinVelocity.raw() = explicitProteinVelocity();
     system.proteinDensity += system.proteinVelocity * timeStep;
+    implicitProteinDiffusion(timeStep);
   }
 
   // regularization
@@ -20,9 +20,11 @@
 
 #ifdef MEM3DG_WITH_NETCDF
 
+#include <algorithm>
 #include <cassert>
 #include <iostream>
 #include <netcdf>
+#include <string>
 #include <vector>
 
 #include "mem3dg/solver/mutable_trajfile.h"
@@ -49,6 +51,141 @@ bool MutableTrajFile::check_metadata() {
 
   return true;
 }
+
+void MutableTrajFile::writeEpochTopology(const std::size_t idx,
+                                         const EigenVectorX3ur &data) {
+  if (!writeable)
+    mem3dg_runtime_error("Cannot write to read only file.");
+  if (!epochs.empty() && idx < epochs.back().start)
+    mem3dg_runtime_error("Cannot rewrite the topology of a frame before the "
+                         "current topology epoch!");
+
+  // a new epoch only starts after the topology is changed, e.g. by flips or
+  // growth; otherwise the frame is appended to the current epoch
+  if (epochs.empty() || data.rows() != epochTopology.rows() ||
+      data != epochTopology)
+    addEpoch(idx, data);
+
+  std::uint32_t epochIndex = epochs.size() - 1;
+  epoch_var.putVar({idx}, &epochIndex);
+  nTopologyFrames = std::max(nTopologyFrames, idx + 1);
+}
+
+void MutableTrajFile::writeTopologyReference(const std::size_t idx) {
+  if (!writeable)
+    mem3dg_runtime_error("Cannot write to read only file.");
+
+  if (isChunked) {
+    if (epochs.empty() || idx < epochs.back().start)
+      mem3dg_runtime_error("No topology to reference for the frame!");
+    std::uint32_t epochIndex = epochs.size() - 1;
+    epoch_var.putVar({idx}, &epochIndex);
+    nTopologyFrames = std::max(nTopologyFrames, idx + 1);
+    return;
+  }
+
+  if (!isTopologyWritten || idx < lastTopologyFrame)
+    mem3dg_runtime_error("No topology to reference for the frame!");
+  if (topo_frame_var.isNull()) {
+    // files written before topology references store every frame in full
+    writeVar<std::uint32_t, 3>(topo_var, idx, getTopology(lastTopologyFrame));
+  } else {
+    writeVar(topo_frame_var, idx,
+             static_cast<unsigned long long>(lastTopologyFrame));
+  }
+}
+
+void MutableTrajFile::addEpoch(const std::size_t start,
+                               const EigenVectorX3ur &topology) {
+  const int compression_level = 5;
+
+  Epoch epoch;
+  epoch.start = start;
+  epoch.nVertices = (topology.size() == 0) ? 0 : topology.maxCoeff() + 1;
+  epoch.group = traj_group.addGroup(EPOCH_GROUP_PREFIX +
+                                    std::to_string(epochs.size()));
+  epoch.group.putAtt(FIRST_FRAME_NAME, nc::ncUint64,
+                     static_cast<unsigned long long>(start));
+
+  nc::NcDim frame = epoch.group.addDim(EPOCH_FRAME_NAME);
+  nc::NcDim nvertices = epoch.group.addDim(NVERTICES_NAME, epoch.nVertices);
+  nc::NcDim npolygons = epoch.group.addDim(NPOLYGONS_NAME, topology.rows());
+  nc::NcDim polygon_dims =
+      epoch.group.addDim(POLYGON_ORDER_NAME, POLYGON_ORDER);
+  nc::NcDim spatial = epoch.group.addDim(SPATIAL_DIMS_NAME, SPATIAL_DIMS);
+
+  // the topology is stored once per epoch
+  epoch.topo_var =
+      epoch.group.addVar(TOPO_VAR, nc::ncUint, {npolygons, polygon_dims});
+  epoch.topo_var.setCompression(true, true, compression_level);
+  epoch.topo_var.putVar(topology.data());
+
+  // one chunk per frame, so that a frame is read without decompressing others
+  std::vector<std::size_t> vectorChunk{1, epoch.nVertices, SPATIAL_DIMS};
+  std::vector<std::size_t> scalarChunk{1, epoch.nVertices};
+  auto addVectorVar = [&](const std::string &name,
+                          const VariableStorage &varStorage) {
+    nc::NcVar var = epoch.group.addVar(name, varStorage.ncType(),
+                                       {frame, nvertices, spatial});
+    var.setChunking(nc::NcVar::nc_CHUNKED, vectorChunk);
+    var.setCompression(true, true, compression_level);
+    varStorage.putAttributes(var);
+    return var;
+  };
+  epoch.coord_var = addVectorVar(COORD_VAR, storage.coordinates);
+  epoch.coord_var.putAtt(UNITS, LEN_UNITS);
+  epoch.vel_var = addVectorVar(VEL_VAR, storage.velocity);
+  epoch.extF_var = addVectorVar(EXTF_VAR, storage.externalForce);
+  epoch.extF_var.putAtt(UNITS, FORCE_UNITS);
+  epoch.phi_var = epoch.group.addVar(PHI_VAR, storage.proteinDensity.ncType(),
+                                     {frame, nvertices});
+  epoch.phi_var.setChunking(nc::NcVar::nc_CHUNKED, scalarChunk);
+  epoch.phi_var.setCompression(true, true, compression_level);
+  storage.proteinDensity.putAttributes(epoch.phi_var);
+
+  epochs.push_back(epoch);
+  epochTopology = topology;
+}
+
+void MutableTrajFile::loadEpochs() {
+  epochs.clear();
+  for (std::size_t k = 0;; ++k) {
+    nc::NcGroup group =
+        traj_group.getGroup(EPOCH_GROUP_PREFIX + std::to_string(k));
+    if (group.isNull())
+      break;
+
+    Epoch epoch;
+    unsigned long long start;
+    group.getAtt(FIRST_FRAME_NAME).getValues(&start);
+    epoch.start = start;
+    epoch.nVertices = group.getDim(NVERTICES_NAME).getSize();
+    epoch.group = group;
+    epoch.topo_var = group.getVar(TOPO_VAR);
+    epoch.coord_var = group.getVar(COORD_VAR);
+    epoch.phi_var = group.getVar(PHI_VAR);
+    epoch.vel_var = group.getVar(VEL_VAR);
+    epoch.extF_var = group.getVar(EXTF_VAR);
+    epochs.push_back(epoch);
+  }
+
+  nTopologyFrames = nFrames();
+  if (epochs.empty()) {
+    epochTopology.resize(0, POLYGON_ORDER);
+  } else {
+    epochTopology = getTopology(epochs.back().start);
+    // every epoch is created with the storage of the file
+    const Epoch &first = epochs.front();
+    storage.coordinates = VariableStorage::fromVariable(
+        first.coord_var, first.coord_var.getType());
+    storage.proteinDensity =
+        VariableStorage::fromVariable(first.phi_var, first.phi_var.getType());
+    storage.velocity =
+        VariableStorage::fromVariable(first.vel_var, first.vel_var.getType());
+    storage.externalForce =
+        VariableStorage::fromVariable(first.extF_var, first.extF_var.getType());
+  }
+}
 } // namespace solver
 } // namespace mem3dg
 
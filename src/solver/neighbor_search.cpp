@@ -0,0 +1,109 @@
+// Membrane Dynamics in 3D using Discrete Differential Geometry (Mem3DG)
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Copyright (c) 2020:
+//     Laboratory for Computational Cellular Mechanobiology
+//     Cuncheng Zhu (cuzhu@eng.ucsd.edu)
+//     Christopher T. Lee (ctlee@ucsd.edu)
+//     Ravi Ramamoorthi (ravir@cs.ucsd.edu)
+//     Padmini Rangamani (prangamani@eng.ucsd.edu)
+//
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+
+#include "mem3dg/macros.h"
+#include "mem3dg/solver/neighbor_search.h"
+
+namespace mem3dg {
+namespace solver {
+
+std::uint64_t CellList::cellKey(std::int64_t x, std::int64_t y,
+                                std::int64_t z) {
+  // 21 bits per axis; aliasing of far away cells only adds candidates that are
+  // rejected by the distance check
+  const std::uint64_t mask = (std::uint64_t(1) << 21) - 1;
+  return ((std::uint64_t(x + 1) & mask) << 42) |
+         ((std::uint64_t(y + 1) & mask) << 21) | (std::uint64_t(z + 1) & mask);
+}
+
+void CellList::build(const Eigen::Ref<const EigenVectorX3dr> &positions,
+                     double cutoff_) {
+  if (!(cutoff_ > 0)) {
+    mem3dg_runtime_error("Cell list cutoff has to be positive!");
+  }
+  cutoff = cutoff_;
+  points = positions;
+  const std::size_t nPoints = points.rows();
+
+  pointCells.resize(nPoints, 3);
+  sortedPoints.resize(nPoints);
+  cellRanges.clear();
+  if (nPoints == 0)
+    return;
+
+  origin = points.colwise().minCoeff().transpose();
+  for (std::size_t i = 0; i < nPoints; ++i) {
+    for (int k = 0; k < 3; ++k) {
+      pointCells(i, k) = static_cast<std::int64_t>(
+          std::floor((points(i, k) - origin[k]) / cutoff));
+    }
+  }
+
+  // counting sort would need the grid extent, sorting by key is cheap enough
+  std::vector<std::uint64_t> keys(nPoints);
+  for (std::size_t i = 0; i < nPoints; ++i) {
+    keys[i] = cellKey(pointCells(i, 0), pointCells(i, 1), pointCells(i, 2));
+  }
+  std::iota(sortedPoints.begin(), sortedPoints.end(), 0);
+  std::sort(sortedPoints.begin(), sortedPoints.end(),
+            [&keys](std::size_t a, std::size_t b) {
+              return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+            });
+
+  std::size_t begin = 0;
+  for (std::size_t k = 1; k <= nPoints; ++k) {
+    if (k == nPoints || keys[sortedPoints[k]] != keys[sortedPoints[begin]]) {
+      cellRanges[keys[sortedPoints[begin]]] = std::make_pair(begin, k);
+      begin = k;
+    }
+  }
+}
+
+void CellList::findPairs(
+    std::vector<std::pair<std::size_t, std::size_t>> &pairs) const {
+  pairs.clear();
+  const double cutoff2 = cutoff * cutoff;
+  const std::size_t nPoints = points.rows();
+  for (std::size_t i = 0; i < nPoints; ++i) {
+    for (std::int64_t dx = -1; dx <= 1; ++dx) {
+      for (std::int64_t dy = -1; dy <= 1; ++dy) {
+        for (std::int64_t dz = -1; dz <= 1; ++dz) {
+          auto cell = cellRanges.find(cellKey(pointCells(i, 0) + dx,
+                                              pointCells(i, 1) + dy,
+                                              pointCells(i, 2) + dz));
+          if (cell == cellRanges.end())
+            continue;
+          for (std::size_t k = cell->second.first; k < cell->second.second;
+               ++k) {
+            std::size_t j = sortedPoints[k];
+            if (j > i && (points.row(j) - points.row(i)).squaredNorm() <
+                             cutoff2) {
+              pairs.emplace_back(i, j);
+            }
+          }
+        }
+      }
+    }
+  }
+  std::sort(pairs.begin(), pairs.end());
+  // aliased cell keys may visit the same cell twice
+  pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+}
+
+} // namespace solver
+} // namespace mem3dg
@@ -147,9 +147,25 @@ void Parameters::Variation::checkParameters() {
   }
 }
 
+void Parameters::SelfAvoidance::checkParameters() {
+  if (cutoff < 0) {
+    mem3dg_runtime_error("Self avoidance cutoff has to be >= 0 (0 to disable "
+                         "the cell list)!");
+  }
+  if (cutoff != 0 && cutoff <= d) {
+    mem3dg_runtime_error(
+        "Self avoidance cutoff has to be greater than the limit distance d!");
+  }
+  if (theta < 0) {
+    mem3dg_runtime_error("Barnes-Hut opening angle theta has to be >= 0 (0 to "
+                         "disable the approximation)!");
+  }
+}
+
 void Parameters::checkParameters(bool hasBoundary, size_t nVertex) {
   tension.checkParameters();
   osmotic.checkParameters();
+  selfAvoidance.checkParameters();
   variation.checkParameters();
   point.checkParameters();
   proteinDistribution.checkParameters(nVertex);
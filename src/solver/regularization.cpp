@@ -225,8 +225,15 @@ bool System::edgeFlip() {
     }
   }
 
-  if (isFlipped)
+  if (isFlipped) {
     mesh->compress();
+    isSelfAvoidanceExclusionOutdated = true;
+    isEdgeColoringOutdated = true;
+    isGeometryKernelOutdated = true;
+    isPreconditionerOutdated = true;
+    ++topologyVersion;
+    refreshedPositions.resize(0, 3);
+  }
 
   return isFlipped;
 }
@@ -331,8 +338,15 @@ bool System::growMesh() {
       }
     }
   }
-  if (isGrown)
+  if (isGrown) {
     mesh->compress();
+    isSelfAvoidanceExclusionOutdated = true;
+    isEdgeColoringOutdated = true;
+    isGeometryKernelOutdated = true;
+    isPreconditionerOutdated = true;
+    ++topologyVersion;
+    refreshedPositions.resize(0, 3);
+  }
   return isGrown;
 }
 
@@ -377,8 +391,11 @@ System::smoothenMesh(double initStep, double target, size_t maxIteration) {
   double stepSize = initStep;
   double pastGradNorm = 1e10;
   size_t num_iter = 0;
+  // smoothing reads the bending component of the force
+  bool isFullDiagnostics = forces.isFullDiagnostics;
+  forces.isFullDiagnostics = true;
   // compute bending forces
-  vpg->refreshQuantities();
+  refreshGeometry();
   computeMechanicalForces();
   EigenVectorX3dr pastForceVec = toMatrix(forces.bendingForceVec);
   // initialize smoothingMask
@@ -400,7 +417,7 @@ System::smoothenMesh(double initStep, double target, size_t maxIteration) {
     }
 
     // compute bending force if smoothingMask is true
-    vpg->refreshQuantities();
+    refreshGeometry();
     forces.bendingForceVec.fill({0, 0, 0});
     forces.bendingForce.raw().setZero();
     for (std::size_t i = 0; i < mesh->nVertices(); ++i) {
@@ -423,6 +440,7 @@ System::smoothenMesh(double initStep, double target, size_t maxIteration) {
     num_iter++;
     
   };
+  forces.isFullDiagnostics = isFullDiagnostics;
 
   return smoothingMask;
 }
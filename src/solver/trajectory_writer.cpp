@@ -0,0 +1,194 @@
+// Membrane Dynamics in 3D using Discrete Differential Geometry (Mem3DG)
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Copyright (c) 2020:
+//     Laboratory for Computational Cellular Mechanobiology
+//     Cuncheng Zhu (cuzhu@eng.ucsd.edu)
+//     Christopher T. Lee (ctlee@ucsd.edu)
+//     Ravi Ramamoorthi (ravir@cs.ucsd.edu)
+//     Padmini Rangamani (prangamani@eng.ucsd.edu)
+//
+
+/**
+ * @file  trajectory_writer.cpp
+ * @brief Asynchronous netcdf trajectory output
+ *
+ */
+
+#ifdef MEM3DG_WITH_NETCDF
+
+#include <utility>
+
+#include "mem3dg/solver/trajectory_writer.h"
+
+namespace mem3dg {
+namespace solver {
+
+TrajectoryWriter::~TrajectoryWriter() {
+  // errors can not be reported from the destructor
+  try {
+    stop();
+  } catch (...) {
+  }
+}
+
+void TrajectoryWriter::start(MutableTrajFile &file_, std::size_t capacity_,
+                             std::size_t syncPeriod_) {
+  if (isRunning()) {
+    mem3dg_runtime_error("Trajectory writer is already running!");
+  }
+  if (capacity_ == 0) {
+    mem3dg_runtime_error("Trajectory writer queue capacity has to be "
+                         "positive!");
+  }
+  file = &file_;
+  capacity = capacity_;
+  syncPeriod = syncPeriod_;
+  nWritten = 0;
+  isStopping = false;
+  isSyncRequested = false;
+  error = nullptr;
+  worker = std::thread(&TrajectoryWriter::run, this);
+}
+
+TrajectoryWriter::Frame &TrajectoryWriter::acquire() {
+  if (!isRunning()) {
+    mem3dg_runtime_error("Trajectory writer is not running!");
+  }
+  std::unique_lock<std::mutex> lock(mutex);
+  condition.wait(lock, [this] {
+    return queue.size() + (isWriting ? 1 : 0) < capacity || error;
+  });
+  rethrow();
+  if (!pending) {
+    if (pool.empty()) {
+      pending.reset(new Frame);
+    } else {
+      pending = std::move(pool.back());
+      pool.pop_back();
+    }
+  }
+  return *pending;
+}
+
+void TrajectoryWriter::push() {
+  std::lock_guard<std::mutex> lock(mutex);
+  if (!pending) {
+    mem3dg_runtime_error("No acquired frame to push!");
+  }
+  queue.push_back(std::move(pending));
+  condition.notify_all();
+}
+
+void TrajectoryWriter::flush() {
+  if (!isRunning())
+    return;
+  std::unique_lock<std::mutex> lock(mutex);
+  condition.wait(lock, [this] { return queue.empty() && !isWriting; });
+  isSyncRequested = true;
+  condition.notify_all();
+  condition.wait(lock, [this] { return !isSyncRequested; });
+  rethrow();
+}
+
+void TrajectoryWriter::stop() {
+  if (!isRunning())
+    return;
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    isStopping = true;
+    condition.notify_all();
+  }
+  worker.join();
+  file = nullptr;
+  std::lock_guard<std::mutex> lock(mutex);
+  rethrow();
+}
+
+void TrajectoryWriter::rethrow() {
+  if (error) {
+    std::exception_ptr e = error;
+    error = nullptr;
+    std::rethrow_exception(e);
+  }
+}
+
+void TrajectoryWriter::write(const Frame &frame) {
+  std::size_t idx = file->nFrames();
+  file->writeTime(idx, frame.time);
+  // the chunked layout resolves the epoch of the frame from its topology
+  if (frame.topology.rows() != 0)
+    file->writeTopology(idx, frame.topology);
+  else
+    file->writeTopologyReference(idx);
+  file->writeVelocity(idx, frame.velocity);
+  if (frame.externalForce.rows() != 0)
+    file->writeExternalForce(idx, frame.externalForce);
+  file->writeCoords(idx, frame.coords);
+  file->writeProteinDensity(idx, frame.proteinDensity);
+}
+
+void TrajectoryWriter::run() {
+  std::unique_lock<std::mutex> lock(mutex);
+  for (;;) {
+    condition.wait(lock, [this] {
+      return !queue.empty() || isSyncRequested || isStopping;
+    });
+
+    if (!queue.empty()) {
+      std::unique_ptr<Frame> frame = std::move(queue.front());
+      queue.pop_front();
+      isWriting = true;
+      const bool isWriteable = !error;
+      lock.unlock();
+
+      // after an error the frames are only recycled, so that the simulation
+      // does not block before the error is rethrown
+      std::exception_ptr writeError;
+      if (isWriteable) {
+        try {
+          write(*frame);
+          ++nWritten;
+          if (syncPeriod != 0 && nWritten % syncPeriod == 0)
+            file->sync();
+        } catch (...) {
+          writeError = std::current_exception();
+        }
+      }
+
+      lock.lock();
+      if (writeError)
+        error = writeError;
+      isWriting = false;
+      pool.push_back(std::move(frame));
+      condition.notify_all();
+    } else if (isSyncRequested || isStopping) {
+      const bool isExit = !isSyncRequested;
+      const bool isWriteable = !error;
+      lock.unlock();
+      std::exception_ptr syncError;
+      if (isWriteable) {
+        try {
+          file->sync();
+        } catch (...) {
+          syncError = std::current_exception();
+        }
+      }
+      lock.lock();
+      if (syncError)
+        error = syncError;
+      isSyncRequested = false;
+      condition.notify_all();
+      if (isExit)
+        return;
+    }
+  }
+}
+
+} // namespace solver
+} // namespace mem3dg
+
+#endif
@@ -72,8 +72,16 @@ void TrajFile::writeCoords(
 
   assert(data.rows() == nvertices_dim.getSize());
 
-  coord_var.putVar({idx, 0, 0}, {1, nvertices_dim.getSize(), SPATIAL_DIMS},
-                   data.data());
+  // netCDF converts doubles to the stored type, int16 is packed here
+  if (storage.coordinates.precision == StoragePrecision::Int16) {
+    EigenVectorXkr_T<std::int16_t, 3> packed =
+        storage.coordinates.pack<EigenVectorXkr_T<std::int16_t, 3>>(data);
+    coord_var.putVar({idx, 0, 0}, {1, nvertices_dim.getSize(), SPATIAL_DIMS},
+                     packed.data());
+  } else {
+    coord_var.putVar({idx, 0, 0}, {1, nvertices_dim.getSize(), SPATIAL_DIMS},
+                     data.data());
+  }
 }
 
 void TrajFile::writeTopoFrame(const std::size_t idx,
@@ -112,6 +120,7 @@ EigenVectorX3dr TrajFile::getCoords(const std::size_t idx) const {
   EigenVectorX3dr vec(nvertices_dim.getSize(), SPATIAL_DIMS);
   coord_var.getVar({idx, 0, 0}, {1, nvertices_dim.getSize(), SPATIAL_DIMS},
                    vec.data());
+  storage.coordinates.unpack(vec);
   return vec;
 }
 
@@ -187,8 +196,15 @@ void TrajFile::writeVelocity(
 
   assert(data.rows() == nvertices_dim.getSize());
 
-  vel_var.putVar({idx, 0, 0}, {1, nvertices_dim.getSize(), SPATIAL_DIMS},
-                 data.data());
+  if (storage.velocity.precision == StoragePrecision::Int16) {
+    EigenVectorXkr_T<std::int16_t, 3> packed =
+        storage.velocity.pack<EigenVectorXkr_T<std::int16_t, 3>>(data);
+    vel_var.putVar({idx, 0, 0}, {1, nvertices_dim.getSize(), SPATIAL_DIMS},
+                   packed.data());
+  } else {
+    vel_var.putVar({idx, 0, 0}, {1, nvertices_dim.getSize(), SPATIAL_DIMS},
+                   data.data());
+  }
 }
 
 Eigen::Matrix<double, Eigen::Dynamic, SPATIAL_DIMS>
@@ -198,6 +214,7 @@ TrajFile::getVelocity(const std::size_t idx) const {
   EigenVectorX3dr vec(nvertices_dim.getSize(), SPATIAL_DIMS);
   vel_var.getVar({idx, 0, 0}, {1, nvertices_dim.getSize(), SPATIAL_DIMS},
                  vec.data());
+  storage.velocity.unpack(vec);
   return vec;
 }
 
@@ -210,7 +227,13 @@ void TrajFile::writeProteinDensity(
 
   assert(data.rows() == nvertices_dim.getSize());
 
-  phi_var.putVar({idx, 0}, {1, nvertices_dim.getSize()}, data.data());
+  if (storage.proteinDensity.precision == StoragePrecision::Int16) {
+    EigenVectorX1_T<std::int16_t> packed =
+        storage.proteinDensity.pack<EigenVectorX1_T<std::int16_t>>(data);
+    phi_var.putVar({idx, 0}, {1, nvertices_dim.getSize()}, packed.data());
+  } else {
+    phi_var.putVar({idx, 0}, {1, nvertices_dim.getSize()}, data.data());
+  }
 }
 
 Eigen::Matrix<double, Eigen::Dynamic, 1>
@@ -220,6 +243,7 @@ TrajFile::getProteinDensity(const std::size_t idx) const {
   Eigen::Matrix<double, Eigen::Dynamic, 1> vec(nvertices_dim.getSize(), 1);
 
   phi_var.getVar({idx, 0}, {1, nvertices_dim.getSize()}, vec.data());
+  storage.proteinDensity.unpack(vec);
   return vec;
 }
 
@@ -66,7 +66,11 @@ void visualize(mem3dg::solver::System &f) {
        f.forces.osmoticForce.raw() + f.forces.externalForce.raw() +
        f.forces.lineCapillaryForce.raw();
 
-  /// Read element data
+  /// Read element data, some of which are not kept by the system
+  f.vpg->requireVertexGaussianCurvatures();
+  f.vpg->requireVertexLumpedMassMatrix();
+  f.vpg->requireCotanLaplacian();
+  f.vpg->requireEdgeCotanWeights();
   polyscope::getSurfaceMesh("Membrane")
       ->addVertexScalarQuantity("mean_curvature",
                                 f.vpg->vertexMeanCurvatures.raw().array() /
@@ -102,6 +106,10 @@ void visualize(mem3dg::solver::System &f) {
       ->addEdgeScalarQuantity("cotan weight", f.vpg->edgeCotanWeights);
   polyscope::getSurfaceMesh("Membrane")
       ->addEdgeScalarQuantity("edge_length", f.vpg->edgeLengths);
+  f.vpg->unrequireVertexGaussianCurvatures();
+  f.vpg->unrequireVertexLumpedMassMatrix();
+  f.vpg->unrequireCotanLaplacian();
+  f.vpg->unrequireEdgeCotanWeights();
   polyscope::getSurfaceMesh("Membrane")
       ->addFaceCountQuantity(
           "the point", std::vector<std::pair<std::size_t, int>>{std::make_pair(
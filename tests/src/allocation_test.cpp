@@ -0,0 +1,172 @@
+// Membrane Dynamics in 3D using Discrete Differential Geometry (Mem3DG)
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Copyright (c) 2020:
+//     Laboratory for Computational Cellular Mechanobiology
+//     Cuncheng Zhu (cuzhu@eng.ucsd.edu)
+//     Christopher T. Lee (ctlee@ucsd.edu)
+//     Ravi Ramamoorthi (ravir@cs.ucsd.edu)
+//     Padmini Rangamani (prangamani@eng.ucsd.edu)
+//
+
+#include <atomic>
+#include <cerrno>
+#include <cstddef>
+#include <cstdlib>
+
+#include <gtest/gtest.h>
+
+#include "mem3dg/mem3dg"
+#include <Eigen/Core>
+
+// This file is built into its own test executable, as it replaces the glibc
+// allocator family for the whole process. Allocations are only counted while
+// an AllocationCounter is alive
+#ifdef __GLIBC__
+#include <malloc.h>
+
+extern "C" {
+void *__libc_malloc(std::size_t size);
+void *__libc_calloc(std::size_t n, std::size_t size);
+void *__libc_realloc(void *ptr, std::size_t size);
+void *__libc_memalign(std::size_t alignment, std::size_t size);
+void *__libc_valloc(std::size_t size);
+void *__libc_pvalloc(std::size_t size);
+}
+
+namespace {
+std::atomic<bool> isCountingAllocations{false};
+std::atomic<std::size_t> allocationCount{0};
+
+inline void countAllocation() {
+  if (isCountingAllocations)
+    ++allocationCount;
+}
+
+/**
+ * @brief Count the heap allocations of the process during its lifetime,
+ * including the ones of Eigen which bypass operator new
+ */
+class AllocationCounter {
+public:
+  AllocationCounter() {
+    allocationCount = 0;
+    isCountingAllocations = true;
+  }
+  ~AllocationCounter() { isCountingAllocations = false; }
+  std::size_t count() const { return allocationCount; }
+};
+} // namespace
+
+extern "C" {
+void *malloc(std::size_t size) {
+  countAllocation();
+  return __libc_malloc(size);
+}
+void *calloc(std::size_t n, std::size_t size) {
+  countAllocation();
+  return __libc_calloc(n, size);
+}
+void *realloc(void *ptr, std::size_t size) {
+  countAllocation();
+  return __libc_realloc(ptr, size);
+}
+void *memalign(std::size_t alignment, std::size_t size) {
+  countAllocation();
+  return __libc_memalign(alignment, size);
+}
+void *aligned_alloc(std::size_t alignment, std::size_t size) {
+  countAllocation();
+  return __libc_memalign(alignment, size);
+}
+int posix_memalign(void **ptr, std::size_t alignment, std::size_t size) {
+  countAllocation();
+  if (alignment % sizeof(void *) != 0 || (alignment & (alignment - 1)) != 0)
+    return EINVAL;
+  void *p = __libc_memalign(alignment, size);
+  if (p == nullptr)
+    return ENOMEM;
+  *ptr = p;
+  return 0;
+}
+void *valloc(std::size_t size) {
+  countAllocation();
+  return __libc_valloc(size);
+}
+void *pvalloc(std::size_t size) {
+  countAllocation();
+  return __libc_pvalloc(size);
+}
+}
+#endif
+
+class AllocationTest : public ::testing::Test {
+public:
+  AllocationTest() {
+    std::tie(mesh, vpg) = mem3dg::getCylinderMatrix(1, 10, 10, 5, 0.3);
+
+    p.variation.isShapeVariation = true;
+    p.variation.isProteinVariation = true;
+    p.variation.radius = -1;
+    p.point.isFloatVertex = false;
+    p.point.pt.resize(3, 1);
+    p.point.pt << 0, 0, 1;
+    p.proteinDistribution.protein0.resize(4, 1);
+    p.proteinDistribution.profile = "tanh";
+    p.proteinDistribution.protein0 << 1, 1, 0.7, 0.2;
+    p.proteinDistribution.tanhSharpness = 3;
+
+    /// physical parameters
+    p.bending.Kd = 8.22e-5;
+    p.bending.Kdc = 8.22e-5;
+    p.bending.Kb = 8.22e-5;
+    p.bending.H0c = -1;
+    p.tension.isConstantSurfaceTension = true;
+    p.tension.Ksg = 1e-2;
+    p.adsorption.epsilon = -1e-2;
+    p.aggregation.chi = -1e-2;
+    p.osmotic.isPreferredVolume = false;
+    p.osmotic.isConstantOsmoticPressure = true;
+    p.osmotic.Kv = 1e-2;
+    p.boundary.shapeBoundaryCondition = "pin";
+    p.boundary.proteinBoundaryCondition = "pin";
+    p.proteinMobility = 1;
+    p.dirichlet.eta = 0.001;
+    p.dpd.gamma = 1;
+    p.temperature = 1;
+  }
+
+  Eigen::Matrix<std::size_t, Eigen::Dynamic, 3> mesh;
+  Eigen::Matrix<double, Eigen::Dynamic, 3> vpg;
+
+  mem3dg::solver::Parameters p;
+
+  const double h = 0.1;
+};
+
+/**
+ * @brief Test whether force evaluations after the first one do not allocate
+ * on the heap
+ *
+ */
+TEST_F(AllocationTest, AllocationFreeForcingTest) {
+#ifdef __GLIBC__
+  mem3dg::solver::System f(mesh, vpg, p, 0);
+  for (bool isFullDiagnostics : {true, false}) {
+    f.forces.isFullDiagnostics = isFullDiagnostics;
+    f.computePhysicalForcing(h);
+    std::size_t count;
+    {
+      AllocationCounter counter;
+      f.computePhysicalForcing(h);
+      count = counter.count();
+    }
+    EXPECT_EQ(count, 0u);
+  }
+#else
+  GTEST_SKIP() << "allocation counting requires glibc";
+#endif
+}
@@ -0,0 +1,260 @@
+// Membrane Dynamics in 3D using Discrete Differential Geometry (Mem3DG)
+//
+// This Source Code Form is subject to the terms of the Mozilla Public
+// License, v. 2.0. If a copy of the MPL was not distributed with this
+// file, You can obtain one at http://mozilla.org/MPL/2.0/.
+//
+// Copyright (c) 2020:
+//     Laboratory for Computational Cellular Mechanobiology
+//     Cuncheng Zhu (cuzhu@eng.ucsd.edu)
+//     Christopher T. Lee (ctlee@ucsd.edu)
+//     Ravi Ramamoorthi (ravir@cs.ucsd.edu)
+//     Padmini Rangamani (prangamani@eng.ucsd.edu)
+//
+
+#include <chrono>
+#include <cmath>
+#include <iostream>
+#include <tuple>
+
+#include <Eigen/Core>
+
+#include "mem3dg/constants.h"
+#include "mem3dg/mesh_io.h"
+#include "mem3dg/solver/integrator/conjugate_gradient.h"
+#include "mem3dg/solver/integrator/fire.h"
+#include "mem3dg/solver/system.h"
+#include "mem3dg/type_utilities.h"
+
+namespace {
+using namespace mem3dg;
+using namespace mem3dg::solver;
+
+/**
+ * @brief Average wall time of a callable in milliseconds
+ *
+ * @param function  callable to time
+ * @param nRepetition  number of calls averaged over
+ */
+template <typename Function>
+double averageMilliseconds(Function &&function, std::size_t nRepetition) {
+  auto start = std::chrono::steady_clock::now();
+  for (std::size_t k = 0; k < nRepetition; ++k)
+    function();
+  auto end = std::chrono::steady_clock::now();
+  return std::chrono::duration<double, std::milli>(end - start).count() /
+         nRepetition;
+}
+
+/**
+ * @brief Parameters of the benchmarks, the same as those of the force tests
+ */
+Parameters benchmarkParameters() {
+  Parameters p;
+  p.variation.isShapeVariation = true;
+  p.variation.isProteinVariation = true;
+  p.variation.radius = -1;
+  p.point.isFloatVertex = false;
+  p.point.pt.resize(3, 1);
+  p.point.pt << 0, 0, 1;
+  p.proteinDistribution.protein0.resize(4, 1);
+  p.proteinDistribution.profile = "tanh";
+  p.proteinDistribution.protein0 << 1, 1, 0.7, 0.2;
+  p.proteinDistribution.tanhSharpness = 3;
+  p.bending.Kd = 8.22e-5;
+  p.bending.Kdc = 8.22e-5;
+  p.bending.Kb = 8.22e-5;
+  p.bending.Kbc = 0;
+  p.bending.H0c = -1;
+  p.tension.isConstantSurfaceTension = true;
+  p.tension.Ksg = 1e-2;
+  p.tension.A_res = 0;
+  p.tension.lambdaSG = 0;
+  p.adsorption.epsilon = -1e-2;
+  p.aggregation.chi = -1e-2;
+  p.osmotic.isPreferredVolume = false;
+  p.osmotic.isConstantOsmoticPressure = true;
+  p.osmotic.Kv = 1e-2;
+  p.osmotic.V_res = 0;
+  p.osmotic.Vt = -1;
+  p.osmotic.cam = -1;
+  p.osmotic.n = 1;
+  p.osmotic.lambdaV = 0;
+  p.boundary.shapeBoundaryCondition = "pin";
+  p.boundary.proteinBoundaryCondition = "pin";
+  p.proteinMobility = 1;
+  p.dirichlet.eta = 0.001;
+  p.selfAvoidance.mu = 1e-5;
+  p.dpd.gamma = 0;
+  p.temperature = 0;
+  p.external.Kf = 0;
+  return p;
+}
+
+/**
+ * @brief Barnes-Hut self-avoidance against the exact all-pairs computation
+ * for a range of opening angles
+ */
+void benchmarkSelfAvoidance(std::size_t nSub, std::size_t nRepetition) {
+  Eigen::Matrix<std::size_t, Eigen::Dynamic, 3> topologyMatrix;
+  Eigen::Matrix<double, Eigen::Dynamic, 3> vertexMatrix;
+  std::tie(topologyMatrix, vertexMatrix) =
+      getCylinderMatrix(1, 10, 10, 5, 0.3);
+  System f(topologyMatrix, vertexMatrix, benchmarkParameters(), nSub);
+  auto evaluate = [&f]() {
+    f.computeSelfAvoidanceEnergy();
+    f.computeSelfAvoidanceForce();
+  };
+
+  f.parameters.selfAvoidance.theta = 0;
+  std::cout << "self-avoidance, " << f.mesh->nVertices()
+            << " vertices: exact = "
+            << averageMilliseconds(evaluate, nRepetition) << " ms"
+            << std::endl;
+  const double exactEnergy = f.energy.selfAvoidancePenalty;
+  const EigenVectorX3dr exactForce = toMatrix(f.forces.selfAvoidanceForceVec);
+
+  for (double theta : {0.3, 0.5, 1.0}) {
+    f.parameters.selfAvoidance.theta = theta;
+    double time = averageMilliseconds(evaluate, nRepetition);
+    std::cout << "  theta = " << theta << ": " << time
+              << " ms, energy error = "
+              << std::abs(f.energy.selfAvoidancePenalty - exactEnergy) /
+                     exactEnergy
+              << ", force error = "
+              << (toMatrix(f.forces.selfAvoidanceForceVec) - exactForce)
+                         .norm() /
+                     exactForce.norm()
+              << std::endl;
+  }
+}
+
+/**
+ * @brief Fused geometry kernel against vpg->refreshQuantities()
+ */
+void benchmarkGeometry(std::size_t nSub, std::size_t nRepetition) {
+  Eigen::Matrix<std::size_t, Eigen::Dynamic, 3> topologyMatrix;
+  Eigen::Matrix<double, Eigen::Dynamic, 3> vertexMatrix;
+  std::tie(topologyMatrix, vertexMatrix) =
+      getCylinderMatrix(1, 10, 10, 5, 0.3);
+  System f(topologyMatrix, vertexMatrix, benchmarkParameters(), nSub);
+  f.extraGeometricQuantities = GeometricQuantity::All;
+  toMatrix(f.vpg->inputVertexPositions).col(0) *= 1.1;
+  auto refresh = [&f]() { f.refreshGeometry(); };
+
+  f.isFusedGeometry = false;
+  double refreshTime = averageMilliseconds(refresh, nRepetition);
+  // the first refresh builds the kernel
+  f.isFusedGeometry = true;
+  f.refreshGeometry();
+  double fusedTime = averageMilliseconds(refresh, nRepetition);
+  std::cout << "geometry refresh, " << f.mesh->nVertices()
+            << " vertices: " << refreshTime
+            << " ms, fused geometry kernel: " << fusedTime << " ms"
+            << std::endl;
+}
+
+/**
+ * @brief Configuration update and protein-only step on a fixed shape, reusing
+ * the cached geometry against refreshing it on every call
+ */
+void benchmarkFrozenGeometry(std::size_t nSub, std::size_t nRepetition) {
+  Eigen::Matrix<std::size_t, Eigen::Dynamic, 3> topologyMatrix;
+  Eigen::Matrix<double, Eigen::Dynamic, 3> vertexMatrix;
+  std::tie(topologyMatrix, vertexMatrix) =
+      getCylinderMatrix(1, 10, 10, 5, 0.3);
+  Parameters p = benchmarkParameters();
+  p.variation.isShapeVariation = false;
+  System f(topologyMatrix, vertexMatrix, p, nSub);
+
+  // refreshing first is the cost of updateConfigurations before the frozen
+  // path, which then only updates the protein-dependent quantities
+  auto refreshedUpdate = [&f]() {
+    f.refreshGeometry();
+    f.updateConfigurations(false);
+  };
+  auto frozenUpdate = [&f]() { f.updateConfigurations(false); };
+  auto refreshedStep = [&f, &refreshedUpdate]() {
+    refreshedUpdate();
+    f.computePhysicalForcing();
+  };
+  auto frozenStep = [&f, &frozenUpdate]() {
+    frozenUpdate();
+    f.computePhysicalForcing();
+  };
+  std::cout << "fixed shape, " << f.mesh->nVertices()
+            << " vertices: configuration update "
+            << averageMilliseconds(refreshedUpdate, nRepetition)
+            << " ms refreshed, "
+            << averageMilliseconds(frozenUpdate, nRepetition)
+            << " ms frozen; protein step "
+            << averageMilliseconds(refreshedStep, nRepetition)
+            << " ms refreshed, "
+            << averageMilliseconds(frozenStep, nRepetition) << " ms frozen"
+            << std::endl;
+}
+
+/**
+ * @brief Iterations and time of conjugate gradient and FIRE to reduce the
+ * force norm of a deflating vesicle by a fixed ratio
+ */
+void benchmarkRelaxation(std::size_t nSub) {
+  Eigen::Matrix<std::size_t, Eigen::Dynamic, 3> topologyMatrix;
+  Eigen::Matrix<double, Eigen::Dynamic, 3> vertexMatrix;
+  std::tie(topologyMatrix, vertexMatrix) = getIcosphereMatrix(1, nSub);
+  // the parameters of the integrator tests
+  Parameters p;
+  p.bending.Kbc = 8.22e-5;
+  p.tension.Ksg = 0.1;
+  p.tension.At = 4.0 * constants::PI;
+  p.osmotic.isPreferredVolume = true;
+  p.osmotic.Kv = 0.01;
+  p.osmotic.Vt = 4.0 / 3.0 * constants::PI * 0.7;
+  const double dt = 0.5, T = 50, eps = 0, tSave = 10;
+  const double reduction = 1e-2;
+  const std::size_t maxIteration = 2000;
+
+  auto relax = [&](auto &integrator, System &f) {
+    integrator.verbosity = 0;
+    f.computePhysicalForcing();
+    const double initialNorm = f.mechErrorNorm;
+    std::size_t iteration = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (iteration < maxIteration &&
+           f.mechErrorNorm > reduction * initialNorm) {
+      integrator.step(1);
+      ++iteration;
+    }
+    auto end = std::chrono::steady_clock::now();
+    std::cout << iteration << " iterations, "
+              << std::chrono::duration<double, std::milli>(end - start).count()
+              << " ms";
+  };
+
+  // the integrators announce themselves on construction
+  System f(topologyMatrix, vertexMatrix, p, 0);
+  integrator::ConjugateGradient cg{f, dt, T, tSave, eps, "/tmp"};
+  System g(topologyMatrix, vertexMatrix, p, 0);
+  integrator::FIRE fire{g, dt, T, tSave, eps, "/tmp"};
+
+  std::cout << "relaxation, " << f.mesh->nVertices()
+            << " vertices: conjugate gradient ";
+  relax(cg, f);
+  std::cout << " (" << cg.getAverageLineSearchEvaluations()
+            << " energy evaluations per step), FIRE ";
+  relax(fire, g);
+  std::cout << std::endl;
+}
+} // namespace
+
+int main() {
+  for (std::size_t nSub : {0, 1, 2})
+    benchmarkSelfAvoidance(nSub, 5);
+  for (std::size_t nSub : {0, 1, 2, 3})
+    benchmarkGeometry(nSub, 10);
+  for (std::size_t nSub : {0, 1, 2, 3})
+    benchmarkFrozenGeometry(nSub, 10);
+  for (std::size_t nSub : {3, 4})
+    benchmarkRelaxation(nSub);
+  return 0;
+}
@@ -12,6 +12,8 @@
 //     Padmini Rangamani (prangamani@eng.ucsd.edu)
 //
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 #include <gtest/gtest.h>
@@ -25,6 +27,10 @@
 
 #include <Eigen/Core>
 
+#ifdef MEM3DG_WITH_OPENMP
+#include <omp.h>
+#endif
+
 #include "mem3dg/mesh_io.h"
 #include "mem3dg/solver/system.h"
 #include "mem3dg/type_utilities.h"
@@ -131,6 +137,368 @@ TEST_F(ForceTest, ConservativeForcesTest) {
   //   1e-12);
 };
 
+#ifdef MEM3DG_WITH_OPENMP
+/**
+ * @brief Test whether threaded force assembly is bitwise identical to the
+ * single threaded one
+ *
+ */
+TEST_F(ForceTest, ThreadInvariantForcesTest) {
+  std::size_t nSub = 0;
+  mem3dg::solver::System f(topologyMatrix, vertexMatrix, p, nSub);
+  const int maxThreads = omp_get_max_threads();
+
+  omp_set_num_threads(1);
+  f.computePhysicalForcing();
+  EigenVectorX3dr mechanicalForceVec1 = toMatrix(f.forces.mechanicalForceVec);
+  EigenVectorX1d mechanicalForce1 = toMatrix(f.forces.mechanicalForce);
+
+  omp_set_num_threads(std::max(maxThreads, 4));
+  f.computePhysicalForcing();
+  EigenVectorX3dr mechanicalForceVec2 = toMatrix(f.forces.mechanicalForceVec);
+  EigenVectorX1d mechanicalForce2 = toMatrix(f.forces.mechanicalForce);
+  omp_set_num_threads(maxThreads);
+
+  EXPECT_TRUE(mechanicalForceVec1 == mechanicalForceVec2);
+  EXPECT_TRUE(mechanicalForce1 == mechanicalForce2);
+};
+#endif
+
+/**
+ * @brief Test whether vertexwise force computation refreshing its own stencil
+ * of the halfedge cache agrees with the global computation
+ *
+ */
+TEST_F(ForceTest, VertexwiseForcesTest) {
+  std::size_t nSub = 0;
+  mem3dg::solver::System f(topologyMatrix, vertexMatrix, p, nSub);
+  f.computeMechanicalForces();
+  EigenVectorX3dr bendingForceVec1 = toMatrix(f.forces.bendingForceVec);
+  EigenVectorX3dr deviatoricForceVec1 = toMatrix(f.forces.deviatoricForceVec);
+
+  // perturb and recover the geometry to invalidate the cache
+  toMatrix(f.vpg->inputVertexPositions) *= 1.1;
+  f.updateConfigurations(false);
+  f.computeMechanicalForces();
+  toMatrix(f.vpg->inputVertexPositions) /= 1.1;
+  f.updateConfigurations(false);
+  for (std::size_t i = 0; i < f.mesh->nVertices(); ++i) {
+    f.computeMechanicalForces(i);
+  }
+  EigenVectorX3dr bendingForceVec2 = toMatrix(f.forces.bendingForceVec);
+  EigenVectorX3dr deviatoricForceVec2 = toMatrix(f.forces.deviatoricForceVec);
+
+  EXPECT_TRUE(bendingForceVec1.isApprox(bendingForceVec2));
+  EXPECT_TRUE(deviatoricForceVec1.isApprox(deviatoricForceVec2));
+};
+
+/**
+ * @brief Test whether the kernel specialized on inactive terms reproduces the
+ * always active terms and leaves the inactive ones zero
+ *
+ */
+TEST_F(ForceTest, InactiveTermsTest) {
+  std::size_t nSub = 0;
+  mem3dg::solver::System f(topologyMatrix, vertexMatrix, p, nSub);
+  EXPECT_EQ(f.activeMechanicalTerms(),
+            static_cast<unsigned>(MechanicalTerm::All));
+  f.computeMechanicalForces();
+  EigenVectorX3dr bendingForceVec1 = toMatrix(f.forces.bendingForceVec);
+  EigenVectorX3dr capillaryForceVec1 = toMatrix(f.forces.capillaryForceVec);
+  EigenVectorX3dr osmoticForceVec1 = toMatrix(f.forces.osmoticForceVec);
+
+  f.parameters.bending.Kd = 0;
+  f.parameters.bending.Kdc = 0;
+  f.parameters.dirichlet.eta = 0;
+  f.parameters.adsorption.epsilon = 0;
+  f.parameters.aggregation.chi = 0;
+  EXPECT_EQ(f.activeMechanicalTerms(), 0u);
+  f.computeMechanicalForces();
+
+  EXPECT_TRUE(bendingForceVec1 == toMatrix(f.forces.bendingForceVec));
+  EXPECT_TRUE(capillaryForceVec1 == toMatrix(f.forces.capillaryForceVec));
+  EXPECT_TRUE(osmoticForceVec1 == toMatrix(f.forces.osmoticForceVec));
+  EXPECT_EQ(toMatrix(f.forces.deviatoricForceVec).norm(), 0);
+  EXPECT_EQ(toMatrix(f.forces.lineCapillaryForceVec).norm(), 0);
+  EXPECT_EQ(toMatrix(f.forces.adsorptionForceVec).norm(), 0);
+  EXPECT_EQ(toMatrix(f.forces.aggregationForceVec).norm(), 0);
+};
+
+/**
+ * @brief Test whether refreshing only the geometric quantities read by the
+ * active terms agrees with refreshing all of them
+ *
+ */
+TEST_F(ForceTest, SelectiveRefreshTest) {
+  std::size_t nSub = 0;
+  p.bending.Kd = 0;
+  p.bending.Kdc = 0;
+  p.dirichlet.eta = 0;
+  p.external.Kf = 0;
+  mem3dg::solver::System f(topologyMatrix, vertexMatrix, p, nSub);
+  EXPECT_EQ(f.activeGeometricQuantities(), 0u);
+
+  f.vpg->inputVertexPositions[0] *= 1.01;
+  f.updateConfigurations(false);
+  f.computePhysicalForcing();
+  double energy1 = f.computePotentialEnergy();
+  EigenVectorX3dr mechanicalForceVec1 = toMatrix(f.forces.mechanicalForceVec);
+
+  f.extraGeometricQuantities = GeometricQuantity::All;
+  EXPECT_EQ(f.activeGeometricQuantities(),
+            static_cast<unsigned>(GeometricQuantity::All));
+  f.updateConfigurations(false);
+  f.computePhysicalForcing();
+  double energy2 = f.computePotentialEnergy();
+  EigenVectorX3dr mechanicalForceVec2 = toMatrix(f.forces.mechanicalForceVec);
+
+  EXPECT_EQ(energy1, energy2);
+  EXPECT_TRUE(mechanicalForceVec1 == mechanicalForceVec2);
+};
+
+/**
+ * @brief Test the fused geometry kernel, including the in place update of the
+ * sparse operators, against vpg->refreshQuantities()
+ *
+ */
+TEST_F(ForceTest, FusedGeometryTest) {
+  std::size_t nSub = 2;
+  mem3dg::solver::System f(topologyMatrix, vertexMatrix, p, nSub);
+  f.extraGeometricQuantities = GeometricQuantity::All;
+  toMatrix(f.vpg->inputVertexPositions).col(0) *= 1.1;
+
+  f.isFusedGeometry = false;
+  f.refreshGeometry();
+  double volume1 = f.volume;
+  EigenVectorX3dr faceNormals1 = gc::EigenMap<double, 3>(f.vpg->faceNormals);
+  EigenVectorX1d faceAreas1 = f.vpg->faceAreas.raw();
+  EigenVectorX1d cornerAngles1 = f.vpg->cornerAngles.raw();
+  EigenVectorX1d halfedgeCotanWeights1 = f.vpg->halfedgeCotanWeights.raw();
+  EigenVectorX1d edgeLengths1 = f.vpg->edgeLengths.raw();
+  EigenVectorX1d edgeDihedralAngles1 = f.vpg->edgeDihedralAngles.raw();
+  EigenVectorX1d vertexDualAreas1 = f.vpg->vertexDualAreas.raw();
+  EigenVectorX3dr vertexNormals1 = toMatrix(f.vpg->vertexNormals);
+  EigenVectorX1d vertexMeanCurvatures1 = f.vpg->vertexMeanCurvatures.raw();
+  EigenVectorX1d vertexGaussianCurvatures1 =
+      f.vpg->vertexGaussianCurvatures.raw();
+  Eigen::SparseMatrix<double> cotanLaplacian1 = f.vpg->cotanLaplacian;
+  Eigen::SparseMatrix<double> vertexLumpedMassMatrix1 =
+      f.vpg->vertexLumpedMassMatrix;
+  Eigen::SparseMatrix<double> hodge1 = f.vpg->hodge1;
+  Eigen::SparseMatrix<double> hodge2 = f.vpg->hodge2;
+
+  // the first refresh builds the kernel, the second updates it in place
+  f.isFusedGeometry = true;
+  f.refreshGeometry();
+  f.refreshGeometry();
+
+  EXPECT_NEAR(volume1, f.volume, 1e-12 * std::abs(volume1));
+  EXPECT_TRUE(
+      faceNormals1.isApprox(gc::EigenMap<double, 3>(f.vpg->faceNormals)));
+  EXPECT_TRUE(faceAreas1.isApprox(f.vpg->faceAreas.raw()));
+  EXPECT_TRUE(cornerAngles1.isApprox(f.vpg->cornerAngles.raw()));
+  EXPECT_TRUE(
+      halfedgeCotanWeights1.isApprox(f.vpg->halfedgeCotanWeights.raw()));
+  EXPECT_TRUE(edgeLengths1.isApprox(f.vpg->edgeLengths.raw()));
+  EXPECT_TRUE(edgeDihedralAngles1.isApprox(f.vpg->edgeDihedralAngles.raw()));
+  EXPECT_TRUE(vertexDualAreas1.isApprox(f.vpg->vertexDualAreas.raw()));
+  EXPECT_TRUE(vertexNormals1.isApprox(toMatrix(f.vpg->vertexNormals)));
+  EXPECT_TRUE(
+      vertexMeanCurvatures1.isApprox(f.vpg->vertexMeanCurvatures.raw()));
+  EXPECT_TRUE(vertexGaussianCurvatures1.isApprox(
+      f.vpg->vertexGaussianCurvatures.raw()));
+  EXPECT_TRUE(cotanLaplacian1.isApprox(f.vpg->cotanLaplacian));
+  EXPECT_TRUE(vertexLumpedMassMatrix1.isApprox(f.vpg->vertexLumpedMassMatrix));
+  EXPECT_TRUE(hodge1.isApprox(f.vpg->hodge1));
+  EXPECT_TRUE(hodge2.isApprox(f.vpg->hodge2));
+};
+
+/**
+ * @brief Test whether protein updates on a fixed geometry, which reuse the
+ * cached geometry, agree with a full geometry refresh
+ *
+ */
+TEST_F(ForceTest, GeometryFrozenTest) {
+  std::size_t nSub = 0;
+  mem3dg::solver::System f(topologyMatrix, vertexMatrix, p, nSub);
+  const EigenVectorX3dr positions = toMatrix(f.vpg->inputVertexPositions);
+  const EigenVectorX1d proteinDensity = 0.9 * toMatrix(f.proteinDensity);
+  // moving a vertex back and forth forces a full refresh
+  auto refresh = [&]() {
+    f.vpg->inputVertexPositions[0] *= 1.01;
+    EXPECT_FALSE(f.isGeometryRefreshed());
+    f.updateConfigurations(false);
+    toMatrix(f.vpg->inputVertexPositions) = positions;
+    f.updateConfigurations(false);
+  };
+
+  refresh();
+  f.proteinDensity.raw() = proteinDensity;
+  f.updateConfigurations(false);
+  EXPECT_TRUE(f.isGeometryRefreshed());
+  double energy1 = f.computePotentialEnergy();
+  f.computeChemicalPotentials();
+  EigenVectorX1d chemicalPotential1 = toMatrix(f.forces.chemicalPotential);
+
+  refresh();
+  double energy2 = f.computePotentialEnergy();
+  f.computeChemicalPotentials();
+  EigenVectorX1d chemicalPotential2 = toMatrix(f.forces.chemicalPotential);
+
+  EXPECT_EQ(energy1, energy2);
+  EXPECT_TRUE(chemicalPotential1 == chemicalPotential2);
+};
+
+/**
+ * @brief Test whether lean force diagnostics reproduce the aggregate forces
+ *
+ */
+TEST_F(ForceTest, LeanDiagnosticsTest) {
+  std::size_t nSub = 0;
+  mem3dg::solver::System f(topologyMatrix, vertexMatrix, p, nSub);
+  f.computePhysicalForcing();
+  EigenVectorX3dr mechanicalForceVec1 = toMatrix(f.forces.mechanicalForceVec);
+  EigenVectorX1d mechanicalForce1 = toMatrix(f.forces.mechanicalForce);
+  EigenVectorX1d chemicalPotential1 = toMatrix(f.forces.chemicalPotential);
+  double mechErrorNorm1 = f.mechErrorNorm;
+
+  f.forces.isFullDiagnostics = false;
+  f.forces.bendingForceVec.fill({0, 0, 0});
+  f.computePhysicalForcing();
+  EXPECT_TRUE(mechanicalForceVec1 == toMatrix(f.forces.mechanicalForceVec));
+  EXPECT_TRUE(mechanicalForce1 == toMatrix(f.forces.mechanicalForce));
+  EXPECT_TRUE(chemicalPotential1 == toMatrix(f.forces.chemicalPotential));
+  EXPECT_EQ(mechErrorNorm1, f.mechErrorNorm);
+  EXPECT_EQ(toMatrix(f.forces.bendingForceVec).norm(), 0);
+
+  // components on demand
+  f.computeForceComponents();
+  EXPECT_FALSE(f.forces.isFullDiagnostics);
+  EXPECT_GT(toMatrix(f.forces.bendingForceVec).norm(), 0);
+  EXPECT_TRUE(mechanicalForceVec1 == toMatrix(f.forces.mechanicalForceVec));
+
+  // terms switched off during a run leave no stale potential behind
+  f.parameters.adsorption.epsilon = 0;
+  f.parameters.dirichlet.eta = 0;
+  f.computePhysicalForcing();
+  EigenVectorX1d chemicalPotential2 = toMatrix(f.forces.chemicalPotential);
+  f.computeForceComponents();
+  EXPECT_TRUE(chemicalPotential2 == toMatrix(f.forces.chemicalPotential));
+  EXPECT_EQ(toMatrix(f.forces.adsorptionPotential).norm(), 0);
+};
+
+/**
+ * @brief Test the counter based random number generator against the known
+ * answers of Philox4x32-10
+ *
+ */
+TEST_F(ForceTest, PhiloxKnownAnswerTest) {
+  using mem3dg::solver::Philox4x32;
+  EXPECT_TRUE((Philox4x32::generate({0, 0, 0, 0}, {0, 0}) ==
+               Philox4x32::Counter{0x6627e8d5, 0xe169c58d, 0xbc57ac4c,
+                                   0x9b00dbd8}));
+  EXPECT_TRUE((Philox4x32::generate({0xffffffff, 0xffffffff, 0xffffffff,
+                                     0xffffffff},
+                                    {0xffffffff, 0xffffffff}) ==
+               Philox4x32::Counter{0x408f276d, 0x41c83b0e, 0xa20bc7c6,
+                                   0x6d5451fd}));
+  EXPECT_TRUE(
+      (Philox4x32::generate({0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344},
+                            {0xa4093822, 0x299f31d0}) ==
+       Philox4x32::Counter{0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1}));
+};
+
+/**
+ * @brief Test whether the DPD noise is reproducible given a seed, and
+ * independent of the number of threads
+ *
+ */
+TEST_F(ForceTest, ReproducibleDPDTest) {
+  std::size_t nSub = 0;
+  p.dpd.gamma = 1;
+  p.temperature = 1;
+  p.dpd.seed = 42;
+  mem3dg::solver::System f1(topologyMatrix, vertexMatrix, p, nSub);
+  mem3dg::solver::System f2(topologyMatrix, vertexMatrix, p, nSub);
+
+#ifdef MEM3DG_WITH_OPENMP
+  const int maxThreads = omp_get_max_threads();
+  omp_set_num_threads(1);
+#endif
+  f1.computeDPDForces(h);
+  EigenVectorX3dr stochasticForceVec1 = toMatrix(f1.forces.stochasticForceVec);
+  f1.computeDPDForces(h);
+  EigenVectorX3dr stochasticForceVec2 = toMatrix(f1.forces.stochasticForceVec);
+#ifdef MEM3DG_WITH_OPENMP
+  omp_set_num_threads(std::max(maxThreads, 4));
+#endif
+  f2.computeDPDForces(h);
+  EigenVectorX3dr stochasticForceVec3 = toMatrix(f2.forces.stochasticForceVec);
+#ifdef MEM3DG_WITH_OPENMP
+  omp_set_num_threads(maxThreads);
+#endif
+
+  EXPECT_TRUE(stochasticForceVec1 == stochasticForceVec3);
+  EXPECT_FALSE(stochasticForceVec1 == stochasticForceVec2);
+  EXPECT_GT(stochasticForceVec1.norm(), 0);
+};
+
+/**
+ * @brief Test whether cell list self-avoidance with cutoff larger than the
+ * mesh reproduces the all-pairs computation
+ *
+ */
+TEST_F(ForceTest, SelfAvoidanceCellListTest) {
+  std::size_t nSub = 0;
+  mem3dg::solver::System f(topologyMatrix, vertexMatrix, p, nSub);
+  f.computeSelfAvoidanceEnergy();
+  f.computeSelfAvoidanceForce();
+  double energy1 = f.energy.selfAvoidancePenalty;
+  EigenVectorX3dr force1 = toMatrix(f.forces.selfAvoidanceForceVec);
+
+  f.parameters.selfAvoidance.cutoff = 100;
+  f.updateConfigurations(false);
+  f.computeSelfAvoidanceEnergy();
+  f.computeSelfAvoidanceForce();
+  double energy2 = f.energy.selfAvoidancePenalty;
+  EigenVectorX3dr force2 = toMatrix(f.forces.selfAvoidanceForceVec);
+
+  EXPECT_DOUBLE_EQ(energy1, energy2);
+  EXPECT_TRUE(force1.isApprox(force2));
+};
+
+/**
+ * @brief Test the error of Barnes-Hut self-avoidance against the exact
+ * all-pairs computation for a range of opening angles
+ *
+ */
+TEST_F(ForceTest, SelfAvoidanceBarnesHutTest) {
+  std::size_t nSub = 0;
+  mem3dg::solver::System f(topologyMatrix, vertexMatrix, p, nSub);
+  f.computeSelfAvoidanceEnergy();
+  f.computeSelfAvoidanceForce();
+  const double exactEnergy = f.energy.selfAvoidancePenalty;
+  const EigenVectorX3dr exactForce = toMatrix(f.forces.selfAvoidanceForceVec);
+
+  for (double theta : {1e-8, 0.3, 0.5, 1.0}) {
+    f.parameters.selfAvoidance.theta = theta;
+    f.computeSelfAvoidanceEnergy();
+    f.computeSelfAvoidanceForce();
+    double energyError =
+        std::abs(f.energy.selfAvoidancePenalty - exactEnergy) / exactEnergy;
+    double forceError =
+        (toMatrix(f.forces.selfAvoidanceForceVec) - exactForce).norm() /
+        exactForce.norm();
+    if (theta < 1e-6) {
+      EXPECT_NEAR(energyError, 0, 1e-10);
+      EXPECT_NEAR(forceError, 0, 1e-10);
+    } else if (theta <= 0.5) {
+      EXPECT_LT(energyError, 1e-2);
+      EXPECT_LT(forceError, 5e-2);
+    }
+  }
+};
+
 /**
  * @brief Test whether integrating with the force will lead to
  * 1. decrease in energy
@@ -12,6 +12,7 @@
 //     Padmini Rangamani (prangamani@eng.ucsd.edu)
 //
 
+#include <csignal>
 #include <iostream>
 
 #include <gtest/gtest.h>
@@ -66,13 +67,202 @@ TEST_F(IntegratorTest, ConjugateGradientIntegratorTest) {
   integrator.integrate();
 }
 
-// TEST_F(IntegratorTest, BFGSIntegratorTest) {
-//   mem3dg::solver::System f(mesh, vpg, p, o, 0);
-//   mem3dg::solver::integrator::BFGS integrator{
-//       f,         dt,        T,     tSave, eps, outputDir, true,
-//       "traj.nc", 0, false, 1,     1,   0.01,      false};
-//   integrator.integrate();
-// }
+TEST_F(IntegratorTest, InterpolatingLineSearchTest) {
+  // an overly large step makes every line search backtrack
+  const double largeStep = 20 * dt;
+  mem3dg::solver::System e(mesh, vpg, p, 0);
+  mem3dg::solver::integrator::ConjugateGradient backtrackIntegrator{
+      e, largeStep, T, tSave, eps, outputDir};
+  backtrackIntegrator.verbosity = verbosity;
+  backtrackIntegrator.step(10);
+
+  mem3dg::solver::System f(mesh, vpg, p, 0);
+  mem3dg::solver::integrator::ConjugateGradient integrator{
+      f, largeStep, T, tSave, eps, outputDir};
+  integrator.verbosity = verbosity;
+  integrator.isInterpolatingLineSearch = true;
+  integrator.step(10);
+  EXPECT_GT(backtrackIntegrator.getAverageLineSearchEvaluations(), 1);
+  EXPECT_LT(integrator.getAverageLineSearchEvaluations(),
+            backtrackIntegrator.getAverageLineSearchEvaluations());
+
+  mem3dg::solver::System g(mesh, vpg, p, 0);
+  mem3dg::solver::integrator::Euler wolfeIntegrator{g,   dt,  T, tSave,
+                                                    eps, outputDir};
+  wolfeIntegrator.verbosity = verbosity;
+  wolfeIntegrator.isInterpolatingLineSearch = true;
+  wolfeIntegrator.isStrongWolfe = true;
+  wolfeIntegrator.step(10);
+  EXPECT_GE(wolfeIntegrator.getAverageLineSearchEvaluations(), 1);
+}
+
+TEST_F(IntegratorTest, LineSearchKeepsAcceptedStepTest) {
+  mem3dg::solver::System f(mesh, vpg, p, 0);
+  mem3dg::solver::integrator::ConjugateGradient integrator{
+      f, dt, T, tSave, eps, outputDir};
+  integrator.verbosity = verbosity;
+  const mem3dg::EigenVectorX3dr initialPosition =
+      mem3dg::toMatrix(f.vpg->inputVertexPositions);
+  integrator.step(1);
+
+  // the energy of the accepted trial is kept for the stepped configuration
+  const double keptEnergy = f.energy.potentialEnergy;
+  f.computePotentialEnergy();
+  EXPECT_DOUBLE_EQ(keptEnergy, f.energy.potentialEnergy);
+  EXPECT_FALSE(
+      initialPosition.isApprox(mem3dg::toMatrix(f.vpg->inputVertexPositions)));
+}
+
+TEST_F(IntegratorTest, SobolevPreconditionedIntegratorTest) {
+  mem3dg::solver::System f(mesh, vpg, p, 0);
+  mem3dg::solver::integrator::Euler integrator{f, dt, T, tSave, eps, outputDir};
+  integrator.verbosity = verbosity;
+  integrator.isSobolevPreconditioned = true;
+  integrator.isAdaptiveStep = false;
+  f.computePotentialEnergy();
+  const double initialEnergy = f.energy.potentialEnergy;
+  integrator.step(10);
+  f.computePotentialEnergy();
+  EXPECT_LT(f.energy.potentialEnergy, initialEnergy);
+
+  mem3dg::solver::System g(mesh, vpg, p, 0);
+  mem3dg::solver::integrator::ConjugateGradient cgIntegrator{
+      g, dt, T, tSave, eps, outputDir};
+  cgIntegrator.trajFileName = "traj.nc";
+  cgIntegrator.verbosity = verbosity;
+  cgIntegrator.isSobolevPreconditioned = true;
+  cgIntegrator.isAdaptiveStep = false;
+  cgIntegrator.integrate();
+}
+
+TEST_F(IntegratorTest, SobolevStableStepTest) {
+  // roughen the sphere such that the high frequencies are excited
+  Eigen::Matrix<double, Eigen::Dynamic, 3> roughVpg =
+      vpg + 5e-3 * Eigen::Matrix<double, Eigen::Dynamic, 3>::Random(
+                       vpg.rows(), 3);
+  const std::size_t nStep = 100;
+  auto isStable = [&](double timeStep, bool isPreconditioned) {
+    mem3dg::solver::System f(mesh, roughVpg, p, 0);
+    mem3dg::solver::integrator::Euler integrator{f,   timeStep, T, tSave,
+                                                 eps, outputDir};
+    integrator.verbosity = verbosity;
+    integrator.isBacktrack = false;
+    integrator.isAdaptiveStep = false;
+    integrator.isSobolevPreconditioned = isPreconditioned;
+    integrator.sobolevScale = 10;
+    f.computePhysicalForcing();
+    const double initialNorm = f.mechErrorNorm;
+    for (std::size_t i = 0; i < nStep; ++i) {
+      integrator.step(1);
+      if (!(f.mechErrorNorm < 10 * initialNorm))
+        return false;
+    }
+    return f.mechErrorNorm < initialNorm;
+  };
+
+  // largest stable step of the bare gradient flow up to a factor of 2
+  double bareStep = 64;
+  while (bareStep > 1e-6 && !isStable(bareStep, false))
+    bareStep /= 2;
+  ASSERT_FALSE(isStable(2 * bareStep, false));
+  EXPECT_TRUE(isStable(32 * bareStep, true));
+
+  // the adaptive step is enlarged accordingly
+  mem3dg::solver::System f(mesh, roughVpg, p, 0);
+  mem3dg::solver::integrator::Euler integrator{f,   bareStep, T, tSave,
+                                               eps, outputDir};
+  integrator.verbosity = verbosity;
+  integrator.isBacktrack = false;
+  integrator.isSobolevPreconditioned = true;
+  integrator.sobolevScale = 10;
+  integrator.step(1);
+  EXPECT_GE(integrator.characteristicTimeStep, 10 * bareStep);
+}
+
+TEST_F(IntegratorTest, ImplicitProteinDiffusionTest) {
+  p.variation.isShapeVariation = false;
+  p.variation.isProteinVariation = true;
+  p.proteinMobility = 1;
+  p.dirichlet.eta = 1;
+  p.proteinDistribution.protein0 = Eigen::MatrixXd::Constant(1, 1, 0.5);
+  mem3dg::solver::System f(mesh, vpg, p, 0);
+  f.proteinDensity.raw().array() +=
+      0.2 * mem3dg::toMatrix(f.vpg->inputVertexPositions).col(2).array();
+  f.updateConfigurations(false);
+  const double initialRange =
+      f.proteinDensity.raw().maxCoeff() - f.proteinDensity.raw().minCoeff();
+
+  // the explicit step would be unstable at this time step
+  mem3dg::solver::integrator::Euler integrator{f, dt, T, tSave, eps, outputDir};
+  integrator.verbosity = verbosity;
+  integrator.isBacktrack = false;
+  integrator.isAdaptiveStep = false;
+  integrator.isImplicitProteinDiffusion = true;
+  integrator.step(10);
+  EXPECT_TRUE(f.proteinDensity.raw().allFinite());
+  EXPECT_LT(f.proteinDensity.raw().maxCoeff() -
+                f.proteinDensity.raw().minCoeff(),
+            initialRange);
+}
+
+TEST_F(IntegratorTest, BFGSIntegratorTest) {
+  mem3dg::solver::System f(mesh, vpg, p, 0);
+  mem3dg::solver::integrator::BFGS integrator{f, dt, T, tSave, eps, outputDir};
+  integrator.trajFileName = "traj.nc";
+  integrator.verbosity = verbosity;
+  integrator.historyLength = 5;
+  integrator.integrate();
+}
+
+TEST_F(IntegratorTest, FIREIntegratorTest) {
+  mem3dg::solver::System f(mesh, vpg, p, 0);
+  mem3dg::solver::integrator::FIRE integrator{f, dt, T, tSave, eps, outputDir};
+  integrator.trajFileName = "traj.nc";
+  integrator.verbosity = verbosity;
+  integrator.integrate();
+}
+
+TEST_F(IntegratorTest, FIREConvergenceTest) {
+  // both minimizers reduce the force norm by a fixed ratio within the budget
+  const double reduction = 1e-2;
+  const std::size_t maxIteration = 2000;
+  auto relax = [&](auto &integrator, mem3dg::solver::System &f) {
+    integrator.verbosity = verbosity;
+    f.computePhysicalForcing();
+    const double initialNorm = f.mechErrorNorm;
+    std::size_t iteration = 0;
+    while (iteration < maxIteration &&
+           f.mechErrorNorm > reduction * initialNorm) {
+      integrator.step(1);
+      ++iteration;
+    }
+    EXPECT_LT(iteration, maxIteration);
+    EXPECT_LE(f.mechErrorNorm, reduction * initialNorm);
+  };
+
+  mem3dg::solver::System f(mesh, vpg, p, 0);
+  mem3dg::solver::integrator::ConjugateGradient cg{f,   dt,       T, tSave,
+                                                   eps, outputDir};
+  relax(cg, f);
+
+  mem3dg::solver::System g(mesh, vpg, p, 0);
+  mem3dg::solver::integrator::FIRE fire{g, dt, T, tSave, eps, outputDir};
+  relax(fire, g);
+}
+
+namespace {
+void customInterruptHandler(int) {}
+} // namespace
+
+TEST_F(IntegratorTest, RestoreInterruptHandlerTest) {
+  auto previousHandler = std::signal(SIGINT, customInterruptHandler);
+  mem3dg::solver::System f(mesh, vpg, p, 0);
+  mem3dg::solver::integrator::Euler integrator{f, dt, T, tSave, eps, outputDir};
+  integrator.trajFileName = "traj.nc";
+  integrator.verbosity = verbosity;
+  integrator.integrate();
+  EXPECT_EQ(std::signal(SIGINT, previousHandler), &customInterruptHandler);
+}
 
 TEST_F(IntegratorTest, VelocityVerletIntegratorTest) {
   mem3dg::solver::System f(mesh, vpg, p, 0);
@@ -12,6 +12,7 @@
 //     Padmini Rangamani (prangamani@eng.ucsd.edu)
 //
 
+#include <fstream>
 #include <iostream>
 
 #include <gtest/gtest.h>
@@ -23,6 +24,10 @@
 #ifdef MEM3DG_WITH_NETCDF
 #include <netcdf>
 
+#ifdef __linux__
+#include <unistd.h>
+#endif
+
 namespace gc = ::geometrycentral;
 namespace gcs = ::geometrycentral::surface;
 
@@ -69,4 +74,187 @@ TEST_F(MutableTrajfileTest, ReadWriteTopologyCoordinates) {
   ASSERT_EQ(coords, g2);
 }
 
+TEST_F(MutableTrajfileTest, TopologyReferenceResolvesToLastWritten) {
+  std::tie(mesh, vpg) = mem3dg::icosphere(1, 0);
+  t1 = mesh->getFaceVertexMatrix<std::uint32_t>();
+  f.writeTopology(0, t1);
+  f.writeTopologyReference(1);
+  f.writeTopologyReference(2);
+
+  std::tie(mesh, vpg) = mem3dg::icosphere(1, 1);
+  t2 = mesh->getFaceVertexMatrix<std::uint32_t>();
+  f.writeTopology(3, *mesh);
+  f.writeTopologyReference(4);
+
+  ASSERT_EQ(f.nFrames(), 5);
+  for (std::size_t i = 0; i < 3; ++i) {
+    ASSERT_EQ(f.getTopologyFrame(i), 0);
+    ASSERT_EQ(f.getTopology(i), t1);
+  }
+  ASSERT_EQ(f.getTopologyFrame(4), 3);
+  ASSERT_EQ(f.getTopology(4), t2);
+}
+
+#ifdef __linux__
+/// resident set size of the process in bytes
+std::size_t residentSetSize() {
+  std::size_t size = 0, resident = 0;
+  std::ifstream statm("/proc/self/statm");
+  statm >> size >> resident;
+  return resident * sysconf(_SC_PAGESIZE);
+}
+
+TEST_F(MutableTrajfileTest, ReadingFramesReleasesVlenStorage) {
+  std::tie(mesh, vpg) = mem3dg::icosphere(1, 2);
+  t1 = mesh->getFaceVertexMatrix<std::uint32_t>();
+  g1 = gc::EigenMap<double, 3>(vpg->inputVertexPositions);
+
+  const std::size_t nFrames = 10000;
+  f.writeTopology(0, t1);
+  for (std::size_t i = 0; i < nFrames; ++i) {
+    f.writeTime(i, i);
+    if (i != 0)
+      f.writeTopologyReference(i);
+    f.writeCoords(i, g1);
+  }
+
+  // warm up the chunk cache of netCDF before measuring
+  for (std::size_t i = 0; i < 100; ++i)
+    f.getCoords(i);
+  const std::size_t initialResidentSetSize = residentSetSize();
+
+  mem3dg::EigenVectorX3dr coords(f.getNVertices(0), 3);
+  for (std::size_t i = 0; i < nFrames; ++i) {
+    f.getCoords(i, coords);
+    ASSERT_EQ(f.getCoords(i), g1);
+  }
+  ASSERT_EQ(coords, g1);
+
+  // leaking a copy of each frame would take 2 x 10000 x 162 x 24 bytes
+  ASSERT_LT(residentSetSize(), initialResidentSetSize + 16 * 1024 * 1024);
+}
+#endif
+
+TEST_F(MutableTrajfileTest, ReducedPrecisionStorage) {
+  std::tie(mesh, vpg) = mem3dg::icosphere(1, 1);
+  t1 = mesh->getFaceVertexMatrix<std::uint32_t>();
+  g1 = gc::EigenMap<double, 3>(vpg->inputVertexPositions);
+  mem3dg::EigenVectorX1d phi =
+      mem3dg::EigenVectorX1d::LinSpaced(g1.rows(), 0, 1);
+
+  mem3dg::solver::TrajStorage storage;
+  storage.coordinates = mem3dg::solver::VariableStorage::single();
+  storage.proteinDensity = mem3dg::solver::VariableStorage::quantized(0, 1);
+
+  for (bool isChunked : {false, true}) {
+    mem3dg::solver::MutableTrajFile reduced;
+    reduced.createNewFile("reduced.nc", nc::NcFile::replace, isChunked,
+                          storage);
+    reduced.writeTime(0, 0);
+    reduced.writeTopology(0, t1);
+    reduced.writeCoords(0, g1);
+    reduced.writeProteinDensity(0, phi);
+    reduced.close();
+
+    reduced.open("reduced.nc", nc::NcFile::read);
+    ASSERT_EQ(reduced.getStorage().proteinDensity.precision,
+              mem3dg::solver::StoragePrecision::Int16);
+    ASSERT_LT((reduced.getCoords(0) - g1).cwiseAbs().maxCoeff(), 1e-6);
+    ASSERT_LE((reduced.getProteinDensity(0) - phi).cwiseAbs().maxCoeff(),
+              0.5 * storage.proteinDensity.scale + 1e-12);
+
+    mem3dg::EigenVectorX1d buffer(g1.rows());
+    reduced.getProteinDensity(0, buffer);
+    ASSERT_EQ(buffer, reduced.getProteinDensity(0));
+  }
+}
+
+TEST_F(MutableTrajfileTest, AsyncWriterKeepsFrameOrder) {
+  std::tie(mesh, vpg) = mem3dg::icosphere(1, 1);
+  t1 = mesh->getFaceVertexMatrix<std::uint32_t>();
+  g1 = gc::EigenMap<double, 3>(vpg->inputVertexPositions);
+
+  const std::size_t nFrames = 10;
+  mem3dg::solver::TrajectoryWriter writer;
+  writer.start(f, 2, 3);
+  for (std::size_t i = 0; i < nFrames; ++i) {
+    mem3dg::solver::TrajectoryWriter::Frame &frame = writer.acquire();
+    frame.time = i;
+    frame.coords = g1 * (1.0 + i);
+    frame.topology = t1;
+    frame.velocity = g1;
+    frame.proteinDensity = mem3dg::EigenVectorX1d::Constant(g1.rows(), i);
+    frame.externalForce.resize(0, 3);
+    writer.push();
+  }
+  writer.stop();
+
+  ASSERT_EQ(f.nFrames(), nFrames);
+  for (std::size_t i = 0; i < nFrames; ++i) {
+    ASSERT_EQ(f.getTime(i), double(i));
+    ASSERT_EQ(f.getTopology(i), t1);
+    ASSERT_EQ(f.getCoords(i), mem3dg::EigenVectorX3dr(g1 * (1.0 + i)));
+    ASSERT_EQ(f.getProteinDensity(i)[0], double(i));
+  }
+}
+
+TEST_F(MutableTrajfileTest, ChunkedLayoutPerTopologyEpoch) {
+  mem3dg::solver::MutableTrajFile chunked;
+  chunked.createNewFile("chunked.nc", nc::NcFile::replace, true);
+  ASSERT_TRUE(chunked.isChunkedLayout());
+
+  std::tie(mesh, vpg) = mem3dg::icosphere(1, 0);
+  t1 = mesh->getFaceVertexMatrix<std::uint32_t>();
+  g1 = gc::EigenMap<double, 3>(vpg->inputVertexPositions);
+  for (std::size_t i = 0; i < 2; ++i) {
+    chunked.writeTime(i, i);
+    chunked.writeTopology(i, t1);
+    chunked.writeCoords(i, mem3dg::EigenVectorX3dr(g1 * (1.0 + i)));
+  }
+
+  std::tie(mesh, vpg) = mem3dg::icosphere(1, 1);
+  t2 = mesh->getFaceVertexMatrix<std::uint32_t>();
+  g2 = gc::EigenMap<double, 3>(vpg->inputVertexPositions);
+  chunked.writeTime(2, 2);
+  chunked.writeTopology(2, *mesh);
+  chunked.writeCoords(2, *vpg);
+
+  ASSERT_EQ(chunked.nFrames(), 3);
+  ASSERT_EQ(chunked.nEpochs(), 2);
+  for (std::size_t i = 0; i < 2; ++i) {
+    ASSERT_EQ(chunked.getTopology(i), t1);
+    ASSERT_EQ(chunked.getCoords(i), mem3dg::EigenVectorX3dr(g1 * (1.0 + i)));
+  }
+  ASSERT_EQ(chunked.getTopology(2), t2);
+  ASSERT_EQ(chunked.getCoords(2), g2);
+}
+
+TEST_F(MutableTrajfileTest, ChunkedLayoutIsSmaller) {
+  // a slowly deforming vesicle at fixed topology
+  std::tie(mesh, vpg) = mem3dg::icosphere(1, 3);
+  t1 = mesh->getFaceVertexMatrix<std::uint32_t>();
+  g1 = gc::EigenMap<double, 3>(vpg->inputVertexPositions);
+  const mem3dg::EigenVectorX3dr velocity = 1e-3 * g1;
+  const mem3dg::EigenVectorX1d phi = 0.5 * (g1.col(2).array() + 1).matrix();
+
+  auto fileSize = [&](bool isChunked) {
+    mem3dg::solver::MutableTrajFile traj;
+    traj.createNewFile("layout.nc", nc::NcFile::replace, isChunked);
+    for (std::size_t i = 0; i < 50; ++i) {
+      traj.writeTime(i, i);
+      traj.writeTopology(i, t1);
+      traj.writeCoords(i, mem3dg::EigenVectorX3dr(g1 + i * velocity));
+      traj.writeVelocity(i, velocity);
+      traj.writeProteinDensity(i, phi);
+    }
+    traj.close();
+    std::ifstream file("layout.nc", std::ios::binary | std::ios::ate);
+    return std::size_t(file.tellg());
+  };
+
+  const std::size_t vlenSize = fileSize(false);
+  const std::size_t chunkedSize = fileSize(true);
+  EXPECT_LT(chunkedSize, vlenSize);
+}
+
 #endif